@@ -6,9 +6,12 @@
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
 
 #include <SFML/System/String.hpp>
 
+#include <cmath>
+
 namespace sfe
 {
 ////////////////////////////////////////////////////////////////////////////////
@@ -150,6 +153,8 @@ RichText& RichText::operator<<(const sf::String& string)
   if (string.isEmpty())
     return *this;
 
+  m_verticesNeedUpdate = true;
+
   // Explode into substrings
   std::vector<sf::String> subStrings = explode(string, '\n');
 
@@ -199,6 +204,7 @@ void RichText::setCharacterSize(unsigned int size)
 
   // Update character size
   m_characterSize = size;
+  m_verticesNeedUpdate = true;
 
   // Set texts character size
   for (Line& line : m_lines)
@@ -216,6 +222,7 @@ void RichText::setFont(const sf::Font& font)
 
   // Update font
   m_font = &font;
+  m_verticesNeedUpdate = true;
 
   // Set texts font
   for (Line& line : m_lines)
@@ -232,6 +239,9 @@ void RichText::clear()
 
   // Reset bounds
   m_bounds = sf::FloatRect();
+
+  m_vertices.clear();
+  m_verticesNeedUpdate = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -267,15 +277,28 @@ sf::FloatRect RichText::getGlobalBounds() const
 ////////////////////////////////////////////////////////////////////////////////
 void RichText::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
-  states.transform *= getTransform();
+  if (!m_font)
+    return;
 
-  for (const Line& line : m_lines)
-    target.draw(line, states);
+  ensureVertices();
+  if (m_vertices.getVertexCount() == 0)
+    return;
+
+  // All the styles and colors share the glyph atlas of the character
+  // size, the whole text is drawn at once
+  states.transform *= getTransform();
+  states.texture = &m_font->getTexture(m_characterSize);
+  target.draw(m_vertices, states);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 RichText::RichText(const sf::Font* font)
-  : m_font(font), m_characterSize(30), m_currentColor(sf::Color::White), m_currentStyle(sf::Text::Regular)
+  : m_font(font)
+  , m_characterSize(30)
+  , m_currentColor(sf::Color::White)
+  , m_currentStyle(sf::Text::Regular)
+  , m_vertices(sf::Triangles)
+  , m_verticesNeedUpdate(false)
 {
 }
 
@@ -307,4 +330,123 @@ void RichText::updateGeometry() const
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void RichText::appendVertices(const sf::Text& text, const sf::Vector2f& offset) const
+{
+  // Same glyph placement as sf::Text
+  const sf::String& string = text.getString();
+  unsigned int size = text.getCharacterSize();
+  bool bold = (text.getStyle() & sf::Text::Bold) != 0;
+  bool underlined = (text.getStyle() & sf::Text::Underlined) != 0;
+  bool strikeThrough = (text.getStyle() & sf::Text::StrikeThrough) != 0;
+  float italicShear = (text.getStyle() & sf::Text::Italic) ? 0.209f : 0.f;
+  float whitespaceWidth = m_font->getGlyph(L' ', size, bold).advance;
+  float lineSpacing = m_font->getLineSpacing(size);
+  sf::Color color = text.getColor();
+
+  float underlineOffset = m_font->getUnderlinePosition(size);
+  float underlineThickness = m_font->getUnderlineThickness(size);
+  sf::FloatRect xBounds = m_font->getGlyph(L'x', size, bold).bounds;
+  float strikeThroughOffset = xBounds.top + xBounds.height / 2.f;
+
+  float x = offset.x;
+  float y = offset.y + static_cast<float>(size);
+  sf::Uint32 prevChar = 0;
+  for (sf::Uint32 curChar : string)
+  {
+    x += m_font->getKerning(prevChar, curChar, size);
+
+    // Lines are closed at each new line
+    if (curChar == L'\n' && prevChar != L'\n')
+    {
+      if (underlined)
+        appendLine(offset.x, x, y, color, underlineOffset, underlineThickness);
+      if (strikeThrough)
+        appendLine(offset.x, x, y, color, strikeThroughOffset, underlineThickness);
+    }
+    prevChar = curChar;
+
+    if (curChar == L' ')
+    {
+      x += whitespaceWidth;
+      continue;
+    }
+    if (curChar == L'\t')
+    {
+      x += whitespaceWidth * 4;
+      continue;
+    }
+    if (curChar == L'\n')
+    {
+      y += lineSpacing;
+      x = offset.x;
+      continue;
+    }
+
+    const sf::Glyph& glyph = m_font->getGlyph(curChar, size, bold);
+    float left = glyph.bounds.left;
+    float top = glyph.bounds.top;
+    float right = glyph.bounds.left + glyph.bounds.width;
+    float bottom = glyph.bounds.top + glyph.bounds.height;
+    float u1 = static_cast<float>(glyph.textureRect.left);
+    float v1 = static_cast<float>(glyph.textureRect.top);
+    float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width);
+    float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height);
+
+    sf::Vertex topLeft(sf::Vector2f(x + left - italicShear * top, y + top), color, sf::Vector2f(u1, v1));
+    sf::Vertex topRight(sf::Vector2f(x + right - italicShear * top, y + top), color, sf::Vector2f(u2, v1));
+    sf::Vertex bottomLeft(sf::Vector2f(x + left - italicShear * bottom, y + bottom), color, sf::Vector2f(u1, v2));
+    sf::Vertex bottomRight(sf::Vector2f(x + right - italicShear * bottom, y + bottom), color, sf::Vector2f(u2, v2));
+    m_vertices.append(topLeft);
+    m_vertices.append(topRight);
+    m_vertices.append(bottomLeft);
+    m_vertices.append(bottomLeft);
+    m_vertices.append(topRight);
+    m_vertices.append(bottomRight);
+
+    x += glyph.advance;
+  }
+
+  if (x > offset.x)
+  {
+    if (underlined)
+      appendLine(offset.x, x, y, color, underlineOffset, underlineThickness);
+    if (strikeThrough)
+      appendLine(offset.x, x, y, color, strikeThroughOffset, underlineThickness);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RichText::appendLine(float left, float right, float lineTop, const sf::Color& color, float offset,
+                          float thickness) const
+{
+  // The font texture has a white pixel at (1, 1) for these lines
+  float top = std::floor(lineTop + offset - (thickness / 2) + 0.5f);
+  float bottom = top + std::floor(thickness + 0.5f);
+  sf::Vector2f texCoords(1, 1);
+
+  m_vertices.append(sf::Vertex(sf::Vector2f(left, top), color, texCoords));
+  m_vertices.append(sf::Vertex(sf::Vector2f(right, top), color, texCoords));
+  m_vertices.append(sf::Vertex(sf::Vector2f(left, bottom), color, texCoords));
+  m_vertices.append(sf::Vertex(sf::Vector2f(left, bottom), color, texCoords));
+  m_vertices.append(sf::Vertex(sf::Vector2f(right, top), color, texCoords));
+  m_vertices.append(sf::Vertex(sf::Vector2f(right, bottom), color, texCoords));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RichText::ensureVertices() const
+{
+  if (!m_verticesNeedUpdate)
+    return;
+
+  m_vertices.clear();
+  for (const Line& line : m_lines)
+  {
+    for (const sf::Text& text : line.getTexts())
+      appendVertices(text, line.getPosition() + text.getPosition());
+  }
+
+  m_verticesNeedUpdate = false;
+}
+
 }  // namespace sfe
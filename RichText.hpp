@@ -9,6 +9,7 @@
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 
 #include <SFML/System/Vector2.hpp>
 
@@ -165,15 +166,33 @@ private:
   //////////////////////////////////////////////////////////////////////////
   void updateGeometry() const;
 
+  //////////////////////////////////////////////////////////////////////////
+  // Append the glyph quads of a text at given offset to the vertices
+  //////////////////////////////////////////////////////////////////////////
+  void appendVertices(const sf::Text& text, const sf::Vector2f& offset) const;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Append an underline or strike through quad, as sf::Text draws them
+  //////////////////////////////////////////////////////////////////////////
+  void appendLine(float left, float right, float lineTop, const sf::Color& color, float offset,
+                  float thickness) const;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Rebuild the vertices of all the lines, if needed
+  //////////////////////////////////////////////////////////////////////////
+  void ensureVertices() const;
+
   //////////////////////////////////////////////////////////////////////////
   // Member data
   //////////////////////////////////////////////////////////////////////////
-  mutable std::vector<Line> m_lines;  ///< List of lines
-  const sf::Font* m_font;             ///< Font
-  unsigned int m_characterSize;       ///< Character size
-  mutable sf::FloatRect m_bounds;     ///< Local bounds
-  sf::Color m_currentColor;           ///< Last used color
-  sf::Text::Style m_currentStyle;     ///< Last style used
+  mutable std::vector<Line> m_lines;   ///< List of lines
+  const sf::Font* m_font;              ///< Font
+  unsigned int m_characterSize;        ///< Character size
+  mutable sf::FloatRect m_bounds;      ///< Local bounds
+  sf::Color m_currentColor;            ///< Last used color
+  sf::Text::Style m_currentStyle;      ///< Last style used
+  mutable sf::VertexArray m_vertices;  ///< Glyph quads of all the lines
+  mutable bool m_verticesNeedUpdate;   ///< Are the vertices outdated
 };
 
 }  // namespace sfe
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <sstream>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <rhoban_utils/util.h>
+#include "camera_view.h"
+
+CameraView::CameraView() : hasFrame(false), frame(0), isSkewKnown(false), skew(0)
+{
+}
+
+void CameraView::showLive(const FrameRing& ring, double time)
+{
+  CameraFrame latest;
+  if (ring.latest(latest))
+  {
+    if (latest.number != frame)
+    {
+      frame = latest.number;
+      upload(latest.image);
+    }
+    skew = latest.time - time;
+    isSkewKnown = true;
+  }
+}
+
+void CameraView::showReplay(const FrameStore& store, FramePrefetcher& prefetcher, double time, size_t number)
+{
+  cv::Mat image;
+  if (store.size())
+  {
+    size_t index = store.indexAt(time);
+    if (store.getNumber(index) != frame && prefetcher.get(index, image))
+    {
+      frame = store.getNumber(index);
+      upload(image);
+    }
+    skew = store.getTime(index) - time;
+    isSkewKnown = true;
+  }
+  else if (number && number != frame)
+  {
+    // Recordings made before the container, one file per frame
+    frame = number;
+    std::stringstream ss;
+    ss << "frame_" << number << ".jpeg";
+    if (rhoban_utils::file_exists(ss.str()))
+    {
+      try
+      {
+        upload(cv::imread(ss.str()));
+      }
+      catch (const cv::Exception&)
+      {
+        std::cerr << "Can't read " << ss.str() << std::endl;
+      }
+    }
+  }
+}
+
+bool CameraView::hasSkew() const
+{
+  return isSkewKnown;
+}
+
+double CameraView::getSkew() const
+{
+  return skew;
+}
+
+void CameraView::draw(sf::RenderWindow& window, double width)
+{
+  if (!hasFrame)
+  {
+    return;
+  }
+
+  sf::Vector2u windowSize = window.getSize();
+  sf::Vector2u textureSize = texture.getSize();
+  double scale = width * windowSize.x / textureSize.x;
+  double margin = 10;
+
+  sf::Sprite sprite(texture);
+  sprite.setScale(scale, scale);
+  sprite.setPosition(windowSize.x - margin - scale * textureSize.x, windowSize.y - margin - scale * textureSize.y);
+
+  // Drawn in window pixels, whatever the field view is
+  sf::View fieldView = window.getView();
+  window.setView(sf::View(sf::FloatRect(0, 0, windowSize.x, windowSize.y)));
+  window.draw(sprite);
+  window.setView(fieldView);
+}
+
+void CameraView::upload(const cv::Mat& image)
+{
+  if (image.empty())
+  {
+    return;
+  }
+
+  // The conversion buffer and texture are reused from frame to frame
+  cv::cvtColor(image, rgba, cv::COLOR_BGR2RGBA);
+  if (!hasFrame || texture.getSize() != sf::Vector2u(rgba.cols, rgba.rows))
+  {
+    if (!texture.create(rgba.cols, rgba.rows))
+    {
+      return;
+    }
+    texture.setSmooth(true);
+  }
+  texture.update(rgba.data);
+  hasFrame = true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "frame_ring.h"
+#include "frame_store.h"
+#include "frame_prefetch.h"
+
+/**
+ * Picture in picture camera panel of the main window.
+ *
+ * The shown frame is uploaded to a single texture, which is only
+ * reallocated when the frame size changes
+ */
+class CameraView
+{
+public:
+  CameraView();
+
+  /**
+   * Live: show the last captured frame, time being the monitoring
+   * time [ms] of the displayed state
+   */
+  void showLive(const FrameRing& ring, double time);
+
+  /**
+   * Replay: show the frame captured the closest to time [ms], or
+   * the legacy file of given frame number without a recording
+   */
+  void showReplay(const FrameStore& store, FramePrefetcher& prefetcher, double time, size_t number);
+
+  /**
+   * Capture time of the shown frame minus the state time [ms]
+   */
+  bool hasSkew() const;
+  double getSkew() const;
+
+  /**
+   * Draw the panel in the bottom right corner of the window,
+   * width being its ratio of the window width
+   */
+  void draw(sf::RenderWindow& window, double width = 0.25);
+
+protected:
+  void upload(const cv::Mat& image);
+
+  sf::Texture texture;
+  cv::Mat rgba;
+  bool hasFrame;
+
+  // Number of the shown frame
+  size_t frame;
+
+  bool isSkewKnown;
+  double skew;
+};
@@ -0,0 +1,115 @@
+#include <opencv2/highgui/highgui.hpp>
+#include "frame_encoder.h"
+
+FrameEncoder::FrameEncoder(Sink sink, size_t workers, size_t maxQueue, double lateMs, int quality)
+  : sink(sink)
+  , workerCount(workers)
+  , maxQueue(maxQueue)
+  , lateMs(lateMs)
+  , quality(quality)
+  , stopping(false)
+  , queueDepth(0)
+  , encoded(0)
+  , dropped(0)
+  , late(0)
+  , maxLatencyMs(0)
+{
+}
+
+FrameEncoder::~FrameEncoder()
+{
+  stop();
+}
+
+void FrameEncoder::start()
+{
+  stopping = false;
+  for (size_t k = 0; k < workerCount; k++)
+  {
+    workers.push_back(new std::thread(&FrameEncoder::run, this));
+  }
+}
+
+bool FrameEncoder::push(const CameraFrame& frame)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (workers.empty() || stopping || queue.size() >= maxQueue)
+    {
+      dropped++;
+      return false;
+    }
+    Job job;
+    job.frame = frame;
+    job.pushed = Clock::now();
+    queue.push_back(job);
+    queueDepth = queue.size();
+  }
+  condition.notify_one();
+
+  return true;
+}
+
+void FrameEncoder::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  condition.notify_all();
+  for (auto worker : workers)
+  {
+    worker->join();
+    delete worker;
+  }
+  workers.clear();
+}
+
+FrameEncoder::Stats FrameEncoder::getStats() const
+{
+  Stats stats;
+  stats.queueDepth = queueDepth;
+  stats.encoded = encoded;
+  stats.dropped = dropped;
+  stats.late = late;
+  stats.maxLatencyMs = maxLatencyMs;
+
+  return stats;
+}
+
+void FrameEncoder::run()
+{
+  std::vector<int> params = { cv::IMWRITE_JPEG_QUALITY, quality };
+  std::vector<unsigned char> jpeg;
+
+  while (true)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty())
+      {
+        return;
+      }
+      job = queue.front();
+      queue.pop_front();
+      queueDepth = queue.size();
+    }
+
+    jpeg.clear();
+    cv::imencode(".jpeg", job.frame.image, jpeg, params);
+    sink(job.frame, jpeg);
+    encoded++;
+
+    double latency = std::chrono::duration<double, std::milli>(Clock::now() - job.pushed).count();
+    if (latency > lateMs)
+    {
+      late++;
+    }
+    double previous = maxLatencyMs;
+    while (latency > previous && !maxLatencyMs.compare_exchange_weak(previous, latency))
+    {
+    }
+  }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "frame_ring.h"
+
+/**
+ * Encodes camera frames to JPEG on a small pool of worker threads.
+ *
+ * Frames are pushed to a bounded queue without ever blocking the
+ * caller, each worker encodes one frame at a time and hands the
+ * result to the sink, which is thus called concurrently
+ */
+class FrameEncoder
+{
+public:
+  typedef std::function<void(const CameraFrame&, const std::vector<unsigned char>&)> Sink;
+
+  struct Stats
+  {
+    // Frames waiting to be encoded
+    size_t queueDepth;
+    // Frames encoded and dropped because the queue was full
+    size_t encoded;
+    size_t dropped;
+    // Frames that reached the sink more than lateMs after being pushed
+    size_t late;
+    // Longest delay between push and sink [ms]
+    double maxLatencyMs;
+  };
+
+  FrameEncoder(Sink sink, size_t workers = 2, size_t maxQueue = 8, double lateMs = 500, int quality = 90);
+  ~FrameEncoder();
+
+  void start();
+
+  /**
+   * Queue a frame for encoding. Never blocks, return false
+   * if the queue is full and the frame was dropped
+   */
+  bool push(const CameraFrame& frame);
+
+  /**
+   * Encode all pending frames and stop the workers
+   */
+  void stop();
+
+  Stats getStats() const;
+
+protected:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Job
+  {
+    CameraFrame frame;
+    Clock::time_point pushed;
+  };
+
+  void run();
+
+  Sink sink;
+  size_t workerCount;
+  size_t maxQueue;
+  double lateMs;
+  int quality;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<Job> queue;
+  bool stopping;
+  std::vector<std::thread*> workers;
+
+  std::atomic<size_t> queueDepth;
+  std::atomic<size_t> encoded;
+  std::atomic<size_t> dropped;
+  std::atomic<size_t> late;
+  std::atomic<double> maxLatencyMs;
+};
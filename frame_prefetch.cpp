@@ -0,0 +1,186 @@
+#include "frame_prefetch.h"
+
+FramePrefetcher::FramePrefetcher(const FrameStore& store, size_t depth)
+  : store(store)
+  , depth(depth)
+  , playhead(0)
+  , step(1)
+  , hasPlayhead(false)
+  , isSeeking(false)
+  , stopping(false)
+  , thread(NULL)
+  , hits(0)
+  , misses(0)
+  , prefetched(0)
+  , skipped(0)
+{
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+  stop();
+}
+
+void FramePrefetcher::start()
+{
+  stopping = false;
+  thread = new std::thread(&FramePrefetcher::run, this);
+}
+
+void FramePrefetcher::stop()
+{
+  if (thread != NULL)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    condition.notify_one();
+    thread->join();
+    delete thread;
+    thread = NULL;
+  }
+}
+
+bool FramePrefetcher::get(size_t index, cv::Mat& image)
+{
+  bool isCached = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (hasPlayhead && !isSeeking && index != playhead)
+    {
+      step = (long)index - (long)playhead;
+    }
+    isSeeking = false;
+    playhead = index;
+    hasPlayhead = true;
+
+    // Evicting what is not ahead of the playhead anymore
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+      if (isWanted(it->first))
+      {
+        ++it;
+      }
+      else
+      {
+        it = cache.erase(it);
+      }
+    }
+
+    auto it = cache.find(index);
+    if (it != cache.end())
+    {
+      image = it->second;
+      isCached = true;
+      hits++;
+    }
+  }
+  condition.notify_one();
+
+  if (isCached)
+  {
+    return true;
+  }
+
+  // Scrubbing to a frame that was not prefetched
+  misses++;
+  if (!store.decode(index, image))
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (isWanted(index))
+  {
+    cache[index] = image;
+  }
+
+  return true;
+}
+
+void FramePrefetcher::seek()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  isSeeking = true;
+}
+
+FramePrefetcher::Stats FramePrefetcher::getStats() const
+{
+  Stats stats;
+  stats.hits = hits;
+  stats.misses = misses;
+  stats.prefetched = prefetched;
+  stats.skipped = skipped;
+
+  return stats;
+}
+
+bool FramePrefetcher::isWanted(size_t index) const
+{
+  long delta = (long)index - (long)playhead;
+  if (delta % step != 0)
+  {
+    return false;
+  }
+  long k = delta / step;
+
+  return k >= 0 && k <= (long)depth;
+}
+
+bool FramePrefetcher::nextTarget(size_t& index) const
+{
+  if (!hasPlayhead)
+  {
+    return false;
+  }
+
+  // Closest frames first, so that the next displayed one is ready soonest
+  for (long k = 1; k <= (long)depth; k++)
+  {
+    long target = (long)playhead + k * step;
+    if (target < 0 || target >= (long)store.size())
+    {
+      return false;
+    }
+    if (!cache.count(target) && !decoding.count(target))
+    {
+      index = target;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void FramePrefetcher::run()
+{
+  while (true)
+  {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this, &index] { return stopping || nextTarget(index); });
+      if (stopping)
+      {
+        return;
+      }
+      decoding.insert(index);
+    }
+
+    cv::Mat image;
+    bool isOk = store.decode(index, image);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    decoding.erase(index);
+    if (isOk && isWanted(index))
+    {
+      cache[index] = image;
+      prefetched++;
+    }
+    else
+    {
+      // The playback moved past this frame while it was decoded
+      skipped++;
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "frame_store.h"
+
+/**
+ * Decodes the frames of a recording ahead of the replay.
+ *
+ * Each get() moves the playhead, the step between two successive
+ * playheads giving the playback direction and speed. A worker
+ * thread then decodes the next frames along that step into a
+ * bounded cache. When the playback outruns the decoding, frames
+ * that fell behind the playhead are dropped and never decoded.
+ * After a seek(), the next playhead is not a step and the
+ * previous step is kept.
+ */
+class FramePrefetcher
+{
+public:
+  struct Stats
+  {
+    // Frames served from the cache or decoded on demand
+    size_t hits;
+    size_t misses;
+    // Frames decoded ahead, and decoded too late to be kept
+    size_t prefetched;
+    size_t skipped;
+  };
+
+  FramePrefetcher(const FrameStore& store, size_t depth = 8);
+  ~FramePrefetcher();
+
+  void start();
+  void stop();
+
+  /**
+   * Decoded frame at given index of the store, from the cache or
+   * decoded right away on a miss. Schedules the prefetch of the
+   * frames following it
+   */
+  bool get(size_t index, cv::Mat& image);
+
+  /**
+   * The next get() jumps to its frame, rather than playing to it
+   */
+  void seek();
+
+  Stats getStats() const;
+
+protected:
+  void run();
+
+  /**
+   * Is index among the frames to keep around the playhead
+   */
+  bool isWanted(size_t index) const;
+
+  /**
+   * Next frame to decode ahead, return false if there is none
+   */
+  bool nextTarget(size_t& index) const;
+
+  const FrameStore& store;
+  size_t depth;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::map<size_t, cv::Mat> cache;
+  std::set<size_t> decoding;
+
+  // Last requested frame, and the signed step between prefetched frames
+  size_t playhead;
+  long step;
+  bool hasPlayhead;
+  bool isSeeking;
+  bool stopping;
+  std::thread* thread;
+
+  std::atomic<size_t> hits;
+  std::atomic<size_t> misses;
+  std::atomic<size_t> prefetched;
+  std::atomic<size_t> skipped;
+};
@@ -0,0 +1,64 @@
+#include <chrono>
+#include "frame_ring.h"
+
+CameraFrame::CameraFrame() : number(0), time(0)
+{
+}
+
+FrameRing::FrameRing(size_t capacity) : slots(capacity), written(0), stopped(false)
+{
+}
+
+void FrameRing::push(size_t number, double time, const cv::Mat& image)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    CameraFrame& slot = slots[written % slots.size()];
+    slot.number = number;
+    slot.time = time;
+    slot.image = image;
+    written++;
+  }
+  condition.notify_all();
+}
+
+bool FrameRing::latest(CameraFrame& frame) const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (written == 0)
+  {
+    return false;
+  }
+  frame = slots[(written - 1) % slots.size()];
+
+  return true;
+}
+
+bool FrameRing::next(uint64_t& cursor, CameraFrame& frame, double timeoutMs)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  auto timeout = std::chrono::microseconds((int64_t)(timeoutMs * 1000));
+  condition.wait_for(lock, timeout, [this, &cursor] { return stopped || written > cursor; });
+  if (stopped || written <= cursor)
+  {
+    return false;
+  }
+
+  if (written - cursor > slots.size())
+  {
+    cursor = written - slots.size();
+  }
+  frame = slots[cursor % slots.size()];
+  cursor++;
+
+  return true;
+}
+
+void FrameRing::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+  }
+  condition.notify_all();
+}
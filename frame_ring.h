@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/**
+ * A captured camera frame
+ */
+struct CameraFrame
+{
+  CameraFrame();
+
+  // Capture frame number
+  size_t number;
+  // Monotonic capture time, on the monitoring clock [ms]
+  double time;
+  cv::Mat image;
+};
+
+/**
+ * Bounded ring of the most recent camera frames, shared between
+ * the capture thread and its consumers (live view, recording).
+ *
+ * Images are shared and not copied: the producer must not write
+ * again into an image once it has been pushed. When a consumer
+ * falls more than capacity frames behind, the oldest frames are
+ * overwritten and it resumes from the oldest one still stored
+ */
+class FrameRing
+{
+public:
+  FrameRing(size_t capacity = 32);
+
+  /**
+   * Producer side: store a frame, overwriting the oldest one
+   */
+  void push(size_t number, double time, const cv::Mat& image);
+
+  /**
+   * Most recent frame, return false if there is none yet
+   */
+  bool latest(CameraFrame& frame) const;
+
+  /**
+   * Wait up to timeoutMs for the frame following cursor, which is
+   * the number of frames already consumed and starts at 0. Return
+   * false on timeout or once stopped
+   */
+  bool next(uint64_t& cursor, CameraFrame& frame, double timeoutMs);
+
+  /**
+   * Wake up all waiting consumers for good
+   */
+  void stop();
+
+protected:
+  mutable std::mutex mutex;
+  std::condition_variable condition;
+  std::vector<CameraFrame> slots;
+
+  // Frames pushed so far
+  uint64_t written;
+  bool stopped;
+};
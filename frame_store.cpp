@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstring>
+#include <opencv2/highgui/highgui.hpp>
+#include "frame_store.h"
+
+static const char frameStoreMagic[4] = { 'R', 'H', 'F', 'R' };
+
+template <typename T>
+static void put(char* out, T value)
+{
+  memcpy(out, &value, sizeof(value));
+}
+
+template <typename T>
+static T get(const char* data)
+{
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+FrameWriter::FrameWriter() : offset(0)
+{
+}
+
+bool FrameWriter::open(const std::string& filename)
+{
+  // Records are only written once the header is complete
+  std::lock_guard<std::mutex> lock(mutex);
+  file.open(filename, std::ios::binary);
+  index.open(filename + ".idx", std::ios::binary);
+  if (!file.good() || !index.good())
+  {
+    file.close();
+    index.close();
+    return false;
+  }
+
+  char header[FRAME_STORE_HEADER_SIZE];
+  memcpy(header, frameStoreMagic, sizeof(frameStoreMagic));
+  put<uint16_t>(header + 4, FRAME_STORE_VERSION);
+  put<uint16_t>(header + 6, 0);
+  file.write(header, sizeof(header));
+  file.flush();
+  offset = sizeof(header);
+
+  return true;
+}
+
+void FrameWriter::write(const CameraFrame& frame, const std::vector<unsigned char>& jpeg)
+{
+  char header[FRAME_STORE_RECORD_HEADER_SIZE];
+  put<uint64_t>(header, frame.number);
+  put<uint32_t>(header + 8, jpeg.size());
+  put<uint32_t>(header + 12, 0);
+  put<double>(header + 16, frame.time);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!file.is_open())
+  {
+    return;
+  }
+  file.write(header, sizeof(header));
+  file.write((const char*)jpeg.data(), jpeg.size());
+  file.flush();
+  offset += sizeof(header);
+
+  // The index only points to records that are entirely on disk
+  char entry[FRAME_STORE_INDEX_ENTRY_SIZE];
+  put<uint64_t>(entry, frame.number);
+  put<uint64_t>(entry + 8, offset);
+  put<uint32_t>(entry + 16, jpeg.size());
+  put<uint32_t>(entry + 20, 0);
+  put<double>(entry + 24, frame.time);
+  index.write(entry, sizeof(entry));
+  index.flush();
+  offset += jpeg.size();
+}
+
+void FrameWriter::close()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  file.close();
+  index.close();
+}
+
+FrameStore::FrameStore()
+{
+}
+
+bool FrameStore::open(const std::string& filename)
+{
+  entries.clear();
+  // Frames are read around the playhead, in both directions, and each
+  // of them spans many pages that the read ahead should bring together
+  if (!file.open(filename, MappedFile::Normal))
+  {
+    return false;
+  }
+  if (file.size() < FRAME_STORE_HEADER_SIZE || memcmp(file.data(), frameStoreMagic, sizeof(frameStoreMagic)) != 0)
+  {
+    file.close();
+    return false;
+  }
+  if (get<uint16_t>(file.data() + 4) != FRAME_STORE_VERSION)
+  {
+    file.close();
+    return false;
+  }
+
+  if (!loadIndex(filename + ".idx") && !rebuildIndex())
+  {
+    return false;
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.number < b.number; });
+
+  return true;
+}
+
+size_t FrameStore::size() const
+{
+  return entries.size();
+}
+
+size_t FrameStore::getNumber(size_t index) const
+{
+  return entries[index].number;
+}
+
+double FrameStore::getTime(size_t index) const
+{
+  return entries[index].time;
+}
+
+size_t FrameStore::indexAt(double time) const
+{
+  if (entries.empty())
+  {
+    return 0;
+  }
+
+  auto it = std::lower_bound(entries.begin(), entries.end(), time,
+                             [](const Entry& entry, double time) { return entry.time < time; });
+  if (it == entries.end())
+  {
+    return entries.size() - 1;
+  }
+  if (it != entries.begin() && time - (it - 1)->time < it->time - time)
+  {
+    it--;
+  }
+
+  return it - entries.begin();
+}
+
+bool FrameStore::decode(size_t index, cv::Mat& image) const
+{
+  const Entry& entry = entries[index];
+
+  // Decoding straight from the mapping, without any copy
+  cv::Mat jpeg(1, entry.size, CV_8UC1, (void*)(file.data() + entry.offset));
+  image = cv::imdecode(jpeg, cv::IMREAD_COLOR);
+
+  return !image.empty();
+}
+
+bool FrameStore::loadIndex(const std::string& filename)
+{
+  MappedFile index;
+  if (!index.open(filename, MappedFile::Sequential))
+  {
+    return false;
+  }
+
+  size_t count = index.size() / FRAME_STORE_INDEX_ENTRY_SIZE;
+  uint64_t end = FRAME_STORE_HEADER_SIZE;
+  entries.resize(count);
+  for (size_t k = 0; k < count; k++)
+  {
+    const char* data = index.data() + k * FRAME_STORE_INDEX_ENTRY_SIZE;
+    entries[k].number = get<uint64_t>(data);
+    entries[k].offset = get<uint64_t>(data + 8);
+    entries[k].size = get<uint32_t>(data + 16);
+    entries[k].time = get<double>(data + 24);
+    if (entries[k].offset + entries[k].size > file.size())
+    {
+      entries.clear();
+      return false;
+    }
+    end = entries[k].offset + entries[k].size;
+  }
+
+  // The container holds records that are not indexed
+  if (end + FRAME_STORE_RECORD_HEADER_SIZE <= file.size())
+  {
+    entries.clear();
+    return false;
+  }
+
+  return true;
+}
+
+bool FrameStore::rebuildIndex()
+{
+  uint64_t offset = FRAME_STORE_HEADER_SIZE;
+  while (offset + FRAME_STORE_RECORD_HEADER_SIZE <= file.size())
+  {
+    Entry entry;
+    entry.number = get<uint64_t>(file.data() + offset);
+    entry.size = get<uint32_t>(file.data() + offset + 8);
+    entry.time = get<double>(file.data() + offset + 16);
+    entry.offset = offset + FRAME_STORE_RECORD_HEADER_SIZE;
+    if (entry.offset + entry.size > file.size())
+    {
+      // Truncated last record
+      break;
+    }
+    entries.push_back(entry);
+    offset = entry.offset + entry.size;
+  }
+
+  return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "frame_ring.h"
+#include "mapped_file.h"
+
+/**
+ * Camera recording layout (host endianness):
+ *
+ * Container: "RHFR" magic, uint16 version, uint16 reserved, then
+ *   records: uint64 frame number, uint32 JPEG size, uint32 reserved,
+ *   double capture time [ms], followed by the JPEG data.
+ *
+ * Side index (container name + ".idx"): one entry per record,
+ *   uint64 frame number, uint64 offset of the JPEG data in the
+ *   container, uint32 JPEG size, uint32 reserved, double capture
+ *   time [ms].
+ *
+ * Records are appended in encoding order, which may differ slightly
+ * from the capture order. The index can be rebuilt from the record
+ * headers if it is missing or behind the container.
+ */
+#define FRAME_STORE_VERSION 1
+#define FRAME_STORE_HEADER_SIZE 8
+#define FRAME_STORE_RECORD_HEADER_SIZE 24
+#define FRAME_STORE_INDEX_ENTRY_SIZE 32
+
+/**
+ * Appends encoded frames to a single container and its index,
+ * write() can be called from several threads
+ */
+class FrameWriter
+{
+public:
+  FrameWriter();
+
+  bool open(const std::string& filename);
+  void write(const CameraFrame& frame, const std::vector<unsigned char>& jpeg);
+  void close();
+
+protected:
+  std::mutex mutex;
+  std::ofstream file;
+  std::ofstream index;
+  uint64_t offset;
+};
+
+/**
+ * Memory mapped camera recording, giving direct access to any
+ * frame through the index
+ */
+class FrameStore
+{
+public:
+  FrameStore();
+
+  bool open(const std::string& filename);
+
+  /**
+   * Number of stored frames
+   */
+  size_t size() const;
+
+  /**
+   * Frame number and capture time [ms] of given frame
+   */
+  size_t getNumber(size_t index) const;
+  double getTime(size_t index) const;
+
+  /**
+   * Frame captured closest to given time [ms]. Frame numbers and
+   * capture times both increase, this is a binary search
+   */
+  size_t indexAt(double time) const;
+
+  /**
+   * Decode given frame
+   */
+  bool decode(size_t index, cv::Mat& image) const;
+
+protected:
+  struct Entry
+  {
+    uint64_t number;
+    uint64_t offset;
+    uint32_t size;
+    double time;
+  };
+
+  bool loadIndex(const std::string& filename);
+  bool rebuildIndex();
+
+  MappedFile file;
+
+  // Sorted by frame number
+  std::vector<Entry> entries;
+};
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cmath>
+#include "heatmap.h"
+
+Heatmap::Heatmap(double width, double height, double cellSize, const sf::Color& color)
+  : width(width), height(height), cellSize(cellSize), color(color), maxWeight(0), isDirty(false)
+{
+  columns = std::ceil(width / cellSize);
+  rows = std::ceil(height / cellSize);
+  cells.resize(columns * rows, 0);
+  pixels.resize(columns * rows * 4, 0);
+}
+
+void Heatmap::clear()
+{
+  std::fill(cells.begin(), cells.end(), 0);
+  maxWeight = 0;
+  isDirty = true;
+}
+
+void Heatmap::add(const sf::Vector2f& pos, float weight)
+{
+  double column = std::floor((pos.x + width / 2) / cellSize);
+  double row = std::floor((height / 2 - pos.y) / cellSize);
+  if (column < 0 || column >= columns || row < 0 || row >= rows || weight <= 0)
+  {
+    return;
+  }
+
+  float& cell = cells[(size_t)row * columns + (size_t)column];
+  cell += weight;
+  maxWeight = std::max(maxWeight, cell);
+  isDirty = true;
+}
+
+bool Heatmap::isEmpty() const
+{
+  return maxWeight <= 0;
+}
+
+void Heatmap::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+  if (isEmpty())
+  {
+    return;
+  }
+  if (isDirty)
+  {
+    updateTexture();
+  }
+
+  sf::Sprite sprite(texture);
+  sprite.setPosition(-width / 2, -height / 2);
+  sprite.setScale(cellSize, cellSize);
+  target.draw(sprite, states);
+}
+
+void Heatmap::updateTexture() const
+{
+  if (texture.getSize() != sf::Vector2u(columns, rows))
+  {
+    texture.create(columns, rows);
+    texture.setSmooth(true);
+  }
+
+  // The square root keeps the rarely visited cells visible
+  for (size_t k = 0; k < cells.size(); k++)
+  {
+    sf::Uint8* pixel = &pixels[k * 4];
+    pixel[0] = color.r;
+    pixel[1] = color.g;
+    pixel[2] = color.b;
+    pixel[3] = maxWeight > 0 ? 180 * std::sqrt(cells[k] / maxWeight) : 0;
+  }
+  texture.update(pixels.data());
+  isDirty = false;
+}
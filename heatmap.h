@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+/**
+ * Occupancy of the field, accumulated into a fixed grid of cells.
+ *
+ * Adding a sample only updates its cell, and the texture is rebuilt
+ * from the grid and uploaded at most once per draw, when samples were
+ * added since. The costs only depend on the grid resolution, never on
+ * how long data has been accumulated.
+ */
+class Heatmap : public sf::Drawable
+{
+public:
+  /**
+   * Grid covering [-width/2, width/2] x [-height/2, height/2] of the
+   * field [m] with square cells of cellSize [m], drawn with given color
+   */
+  Heatmap(double width, double height, double cellSize, const sf::Color& color);
+
+  void clear();
+
+  /**
+   * Add weight (e.g. the time [s] spent) to the cell of given field
+   * position, positions outside of the grid are ignored
+   */
+  void add(const sf::Vector2f& pos, float weight);
+
+  bool isEmpty() const;
+
+protected:
+  /**
+   * Draws the grid in field coordinates (y being flipped on the
+   * view), the cells opacity growing with their weight
+   */
+  void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+  void updateTexture() const;
+
+  double width, height, cellSize;
+  sf::Color color;
+  size_t columns, rows;
+
+  // Weight of each cell, by row from the top of the view
+  std::vector<float> cells;
+  float maxWeight;
+
+  mutable std::vector<sf::Uint8> pixels;
+  mutable sf::Texture texture;
+  mutable bool isDirty;
+};
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <rhoban_utils/timing/time_stamp.h>
+#include "ingest.h"
+
+using namespace rhoban_utils;
+using namespace rhoban_team_play;
+
+TeamSnapshot::TeamSnapshot() : captainTimestamp(0), refereeIp(""), badRefereeIp(false), updates(0)
+{
+  memset(&captainInfo, 0, sizeof(captainInfo));
+}
+
+Ingest::Ingest(int port, int captainPort, int refereePort)
+  : broadcaster(port, -1)
+  , captainBroadcaster(captainPort, -1)
+  , refereeBroadcaster(refereePort, -1)
+  , published(0)
+  , waited(0)
+  , thread(NULL)
+  , stopped(false)
+{
+}
+
+Ingest::~Ingest()
+{
+  stop();
+}
+
+void Ingest::start()
+{
+  if (thread == NULL)
+  {
+    stopped = false;
+    thread = new std::thread(&Ingest::run, this);
+  }
+}
+
+void Ingest::stop()
+{
+  if (thread != NULL)
+  {
+    stopped = true;
+    thread->join();
+    delete thread;
+    thread = NULL;
+  }
+}
+
+bool Ingest::poll()
+{
+  return buffer.update();
+}
+
+bool Ingest::wait(double timeoutMs)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  auto timeout = std::chrono::microseconds((int64_t)(timeoutMs * 1000));
+  condition.wait_for(lock, timeout, [this] { return published != waited; });
+  bool isPublished = published != waited;
+  waited = published;
+
+  return isPublished;
+}
+
+const TeamSnapshot& Ingest::snapshot() const
+{
+  return buffer.front();
+}
+
+void Ingest::run()
+{
+  while (!stopped)
+  {
+    if (receive())
+    {
+      buffer.back() = state;
+      buffer.publish();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        published++;
+      }
+      condition.notify_one();
+    }
+    else
+    {
+      // Sockets are non-blocking, avoid spinning while the field is quiet
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+bool Ingest::receive()
+{
+  bool isUpdate = false;
+
+  TeamPlayInfo info;
+  size_t len = sizeof(info);
+  while (broadcaster.checkMessage((unsigned char*)&info, len))
+  {
+    if (len != sizeof(info))
+    {
+      std::cout << "ERROR: TeamPlayService: invalid message of size=" << len << " instead of " << sizeof(info)
+                << std::endl;
+      len = sizeof(info);
+      continue;
+    }
+    info.timestamp = TimeStamp::now().getTimeMS();
+    if (!state.team.set(info))
+    {
+      std::cout << "ERROR: TeamPlayService: invalid robot id=" << (int)info.id << std::endl;
+      continue;
+    }
+    state.updates++;
+    std::cout << "Receiving data from id=" << (int)info.id << " ts=" << std::setprecision(10) << info.timestamp
+              << std::endl;
+    isUpdate = true;
+  }
+
+  CaptainInfo captainInfo;
+  size_t captainLen = sizeof(captainInfo);
+  while (captainBroadcaster.checkMessage((unsigned char*)&captainInfo, captainLen))
+  {
+    if (captainLen != sizeof(captainInfo))
+    {
+      std::cout << "ERROR: TeamPlayService: invalid captain message of size=" << captainLen << " instead of "
+                << sizeof(captainInfo) << std::endl;
+      captainLen = sizeof(captainInfo);
+      continue;
+    }
+    state.captainInfo = captainInfo;
+    state.captainTimestamp = TimeStamp::now().getTimeMS();
+    state.updates++;
+    std::cout << "Receiving captain data from id=" << captainInfo.id << " ts=" << std::setprecision(10)
+              << state.captainTimestamp << std::endl;
+    isUpdate = true;
+  }
+
+  uint8_t packet[1024];
+  size_t n = sizeof(packet);
+  std::string ip;
+  while (refereeBroadcaster.checkMessage(packet, n, &ip))
+  {
+    if (n > 500)
+    {
+      bool badRefereeIp = (ip != "192.168.1.100");
+      std::stringstream ss;
+      if (badRefereeIp)
+      {
+        ss << "Bad referee IP: ";
+      }
+      else
+      {
+        ss << "Referee IP: ";
+      }
+      ss << ip;
+      if (ss.str() != state.refereeIp)
+      {
+        state.refereeIp = ss.str();
+        state.badRefereeIp = badRefereeIp;
+        isUpdate = true;
+      }
+    }
+    n = sizeof(packet);
+  }
+
+  return isUpdate;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <rhoban_utils/sockets/udp_broadcast.h>
+#include <rhoban_team_play/team_play.h>
+#include "team_state.h"
+#include "triple_buffer.h"
+
+/**
+ * Latest known state of the team
+ */
+struct TeamSnapshot
+{
+  TeamSnapshot();
+
+  TeamState team;
+  rhoban_team_play::CaptainInfo captainInfo;
+
+  // Reception time of the last captain message [ms]
+  double captainTimestamp;
+
+  std::string refereeIp;
+  bool badRefereeIp;
+
+  // Number of team play and captain messages received so far
+  size_t updates;
+};
+
+/**
+ * Receives the team play, captain and referee UDP messages
+ * on a dedicated thread and publishes the latest state to
+ * the render loop without any lock
+ */
+class Ingest
+{
+public:
+  Ingest(int port, int captainPort, int refereePort);
+  ~Ingest();
+
+  void start();
+  void stop();
+
+  /**
+   * Fetch the last published snapshot, return true if it
+   * changed since the previous call. Never blocks, should
+   * only be called from the render thread
+   */
+  bool poll();
+
+  /**
+   * Block until a snapshot is published or timeoutMs elapsed, return
+   * true if a snapshot was published since the previous call
+   */
+  bool wait(double timeoutMs);
+
+  /**
+   * Snapshot fetched by the last poll()
+   */
+  const TeamSnapshot& snapshot() const;
+
+protected:
+  void run();
+
+  /**
+   * Drain the sockets, return true if anything was received
+   */
+  bool receive();
+
+  rhoban_utils::UDPBroadcast broadcaster;
+  rhoban_utils::UDPBroadcast captainBroadcaster;
+  rhoban_utils::UDPBroadcast refereeBroadcaster;
+
+  // State owned by the ingest thread
+  TeamSnapshot state;
+
+  TripleBuffer<TeamSnapshot> buffer;
+
+  // Wakes up the render thread when a snapshot is published
+  std::mutex mutex;
+  std::condition_variable condition;
+  size_t published;
+  size_t waited;
+
+  std::thread* thread;
+  std::atomic<bool> stopped;
+};
@@ -1,87 +1,171 @@
+#include <algorithm>
 #include <iostream>
-#include <regex>
+#include <cstring>
 #include "log.h"
-#include <rhoban_utils/io_tools.h>
-#include <rhoban_utils/util.h>
+#include "parallel.h"
 
-using namespace rhoban_utils;
+/**
+ * Parse decimal digits at p, advancing it. Return false if there is none
+ */
+static bool parseNumber(const char*& p, const char* end, uint32_t& value)
+{
+  const char* start = p;
+  value = 0;
+  while (p < end && *p >= '0' && *p <= '9')
+  {
+    value = value * 10 + (*p - '0');
+    p++;
+  }
+
+  return p != start;
+}
 
-static uint32_t hms(uint8_t h, uint8_t m, uint8_t s)
+/**
+ * Try to parse a "[h:m:s:ms] " prefix at p, followed by a non empty message
+ */
+static bool parseTime(const char* p, const char* end, uint32_t& time)
 {
-  return h * 3600 + m * 60 + s;
+  uint32_t values[4];
+  p++;
+  for (int k = 0; k < 4; k++)
+  {
+    if (!parseNumber(p, end, values[k]) || p >= end || *p != (k < 3 ? ':' : ']'))
+    {
+      return false;
+    }
+    p++;
+  }
+  if (end - p < 2 || *p != ' ')
+  {
+    return false;
+  }
+
+  time = Log::timeOf(values[0], values[1], values[2], values[3]);
+  return true;
+}
+
+/**
+ * Scan the lines of [begin, end), base being the start of the file
+ */
+static void scanLines(const char* base, const char* begin, const char* end, std::vector<Log::Entry>& entries)
+{
+  const char* line = begin;
+  while (line < end)
+  {
+    const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+    if (lineEnd == nullptr)
+    {
+      lineEnd = end;
+    }
+    const char* textEnd = lineEnd;
+    if (textEnd > line && textEnd[-1] == '\r')
+    {
+      textEnd--;
+    }
+
+    // The last time stamp of the line is used, as any text can prefix it
+    const char* p = textEnd;
+    while ((p = (const char*)memrchr(line, '[', p - line)) != nullptr)
+    {
+      Log::Entry entry;
+      if (parseTime(p, textEnd, entry.time))
+      {
+        entry.offset = line - base;
+        entry.length = textEnd - line;
+        entries.push_back(entry);
+        break;
+      }
+    }
+
+    line = lineEnd + 1;
+  }
 }
 
 Log::Log()
 {
 }
 
+uint32_t Log::timeOf(uint8_t hour, uint8_t min, uint8_t sec, uint16_t ms)
+{
+  return (hour * 3600 + min * 60 + sec) * 1000 + ms;
+}
+
 int Log::getEntries()
 {
   return entries.size();
 }
 
+const char* Log::message(const Entry& entry) const
+{
+  return file.data() + entry.offset;
+}
+
 void Log::load(std::string filename)
 {
   entries.clear();
-  std::string data = file2string(filename);
-  std::vector<std::string> lines;
-  split(data, '\n', lines);
+  // Scanned once to build the entries
+  if (!file.open(filename, MappedFile::Sequential))
+  {
+    std::cerr << "Can't open " << filename << std::endl;
+    return;
+  }
 
-  std::regex regex("^(.*)\\[(\\d+):(\\d+):(\\d+):(\\d+)\\] (.+)$");
-  for (auto& line : lines)
+  // Scanning chunks on all cores, then merging them in file order
+  std::vector<TextChunk> chunks = splitLines(file.data(), file.size());
+  std::vector<std::vector<Entry>> chunkEntries(chunks.size());
+  parallelFor(chunks.size(),
+              [&](size_t k) { scanLines(file.data(), chunks[k].first, chunks[k].second, chunkEntries[k]); });
+
+  size_t total = 0;
+  for (auto& part : chunkEntries)
   {
-    std::cmatch cm;
-    if (std::regex_match(line.c_str(), cm, regex))
-    {
-      uint8_t hour = atoi(cm[2].str().c_str());
-      uint8_t min = atoi(cm[3].str().c_str());
-      uint8_t sec = atoi(cm[4].str().c_str());
-
-      Entry e;
-      e.time = hms(hour, min, sec);
-      e.message = cm[0];
-      entries.push_back(e);
-    }
+    total += part.size();
+  }
+  entries.reserve(total);
+  for (auto& part : chunkEntries)
+  {
+    entries.insert(entries.end(), part.begin(), part.end());
   }
+
+  // Messages are then read following the replay, seeks and rewinds included
+  file.advise(MappedFile::Random);
 }
 
-std::vector<Log::Entry> Log::entriesBetween(uint8_t hour1, uint8_t min1, uint8_t sec1, uint8_t hour2, uint8_t min2,
-                                            uint8_t sec2)
+Log::Range Log::entriesBetween(uint32_t from, uint32_t to) const
 {
-  std::vector<Entry> result;
-
-  if (!entries.size())
+  Range range;
+  auto byTime = [](uint32_t time, const Entry& entry) { return time < entry.time; };
+  range.first = entries.data() + (std::upper_bound(entries.begin(), entries.end(), from, byTime) - entries.begin());
+  range.last = entries.data() + (std::upper_bound(entries.begin(), entries.end(), to, byTime) - entries.begin());
+  if (range.last < range.first)
   {
-    return result;
+    range.last = range.first;
   }
 
-  uint32_t from = hms(hour1, min1, sec1);
-  uint32_t to = hms(hour2, min2, sec2);
+  return range;
+}
 
-  size_t A = 0;
-  size_t B = entries.size() - 1;
+const Log::Entry* Log::Range::begin() const
+{
+  return first;
+}
 
-  while (A != B)
-  {
-    size_t M = (A + B) / 2;
-    if (entries[M].time > from)
-    {
-      B = M;
-    }
-    else
-    {
-      A = M + 1;
-    }
-  }
+const Log::Entry* Log::Range::end() const
+{
+  return last;
+}
 
-  while (A < entries.size() && entries[A].time <= to)
-  {
-    if (entries[A].time > from)
-    {
-      result.push_back(entries[A]);
-    }
-    A++;
-  }
+std::reverse_iterator<const Log::Entry*> Log::Range::rbegin() const
+{
+  return std::reverse_iterator<const Entry*>(last);
+}
 
-  return result;
+std::reverse_iterator<const Log::Entry*> Log::Range::rend() const
+{
+  return std::reverse_iterator<const Entry*>(first);
+}
+
+size_t Log::Range::size() const
+{
+  return last - first;
 }
@@ -1,25 +1,61 @@
 #pragma once
 
+#include <cstdint>
+#include <iterator>
 #include <vector>
 #include <string>
+#include "mapped_file.h"
 
 class Log
 {
 public:
+  /**
+   * A line of the log, located by its offset in the mapped file
+   */
   struct Entry
   {
+    // Time of day [ms]
     uint32_t time;
-    std::string message;
+    uint32_t length;
+    uint64_t offset;
+  };
+
+  /**
+   * View over consecutive stored entries, iterable both ways
+   */
+  struct Range
+  {
+    const Entry* first;
+    const Entry* last;
+
+    const Entry* begin() const;
+    const Entry* end() const;
+    std::reverse_iterator<const Entry*> rbegin() const;
+    std::reverse_iterator<const Entry*> rend() const;
+    size_t size() const;
   };
 
   Log();
   void load(std::string log);
 
-  std::vector<Entry> entriesBetween(uint8_t hour1, uint8_t min1, uint8_t sec1, uint8_t hour2, uint8_t min2,
-                                    uint8_t sec2);
+  /**
+   * Time of day [ms]
+   */
+  static uint32_t timeOf(uint8_t hour, uint8_t min, uint8_t sec, uint16_t ms = 0);
+
+  /**
+   * Entries with from < time <= to [ms], without any copy
+   */
+  Range entriesBetween(uint32_t from, uint32_t to) const;
 
   int getEntries();
 
+  /**
+   * Text of given entry, which is not null terminated
+   */
+  const char* message(const Entry& entry) const;
+
 protected:
+  MappedFile file;
   std::vector<Entry> entries;
 };
@@ -0,0 +1,167 @@
+#include <chrono>
+#include "log_writer.h"
+
+LogWriter::LogWriter(size_t maxQueueBytes, size_t flushBytes, double flushMs)
+  : maxQueueBytes(maxQueueBytes)
+  , flushBytes(flushBytes)
+  , flushMs(flushMs)
+  , queueBytes(0)
+  , stopping(false)
+  , thread(NULL)
+  , queueDepth(0)
+  , records(0)
+  , dropped(0)
+  , bytesWritten(0)
+  , lastFlushMs(0)
+  , maxFlushMs(0)
+{
+}
+
+LogWriter::~LogWriter()
+{
+  close();
+}
+
+bool LogWriter::open(const std::string& filename)
+{
+  file.open(filename, std::ios::binary);
+  if (!file.good())
+  {
+    return false;
+  }
+
+  buffer.clear();
+  replayEncodeHeader(buffer);
+  commit();
+
+  stopping = false;
+  thread = new std::thread(&LogWriter::run, this);
+
+  return true;
+}
+
+bool LogWriter::push(const ReplayFrame& frame)
+{
+  Pending pending;
+  pending.time = frame.time;
+  pending.frame = frame.frame;
+  pending.robots.reserve(frame.team.size());
+  for (auto& info : frame.team)
+  {
+    pending.robots.push_back(info);
+  }
+  pending.captainInfo = frame.captainInfo;
+  size_t size = sizeOf(pending);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (thread == NULL || queueBytes + size > maxQueueBytes)
+    {
+      dropped++;
+      return false;
+    }
+    queue.push_back(std::move(pending));
+    queueBytes += size;
+    queueDepth = queue.size();
+  }
+  condition.notify_one();
+
+  return true;
+}
+
+void LogWriter::close()
+{
+  if (thread != NULL)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    condition.notify_one();
+    thread->join();
+    delete thread;
+    thread = NULL;
+    file.close();
+  }
+}
+
+LogWriter::Stats LogWriter::getStats() const
+{
+  Stats stats;
+  stats.queueDepth = queueDepth;
+  stats.records = records;
+  stats.dropped = dropped;
+  stats.bytesWritten = bytesWritten;
+  stats.lastFlushMs = lastFlushMs;
+  stats.maxFlushMs = maxFlushMs;
+
+  return stats;
+}
+
+size_t LogWriter::sizeOf(const Pending& pending)
+{
+  return sizeof(Pending) + pending.robots.size() * sizeof(rhoban_team_play::TeamPlayInfo);
+}
+
+void LogWriter::run()
+{
+  auto lastCommit = std::chrono::steady_clock::now();
+  auto timeout = std::chrono::microseconds((int64_t)(flushMs * 1000));
+  std::deque<Pending> batch;
+  bool done = false;
+
+  while (!done)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait_until(lock, lastCommit + timeout, [this] { return stopping || !queue.empty(); });
+      batch.swap(queue);
+      queueBytes = 0;
+      queueDepth = 0;
+      done = stopping;
+    }
+
+    // Encoding outside of the lock, the render thread can keep pushing
+    for (auto& pending : batch)
+    {
+      current.time = pending.time;
+      current.frame = pending.frame;
+      current.team.clear();
+      for (auto& info : pending.robots)
+      {
+        current.team.set(info);
+      }
+      current.captainInfo = pending.captainInfo;
+      encoder.encode(current, buffer);
+    }
+    records += batch.size();
+    batch.clear();
+
+    bool expired = std::chrono::steady_clock::now() >= lastCommit + timeout;
+    if (!buffer.empty() && (done || expired || buffer.size() >= flushBytes))
+    {
+      commit();
+      lastCommit = std::chrono::steady_clock::now();
+    }
+    else if (buffer.empty())
+    {
+      lastCommit = std::chrono::steady_clock::now();
+    }
+  }
+}
+
+void LogWriter::commit()
+{
+  auto start = std::chrono::steady_clock::now();
+  file.write(buffer.data(), buffer.size());
+  file.flush();
+  double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  bytesWritten += buffer.size();
+  lastFlushMs = duration;
+  if (duration > maxFlushMs)
+  {
+    maxFlushMs = duration;
+  }
+  buffer.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "replay.h"
+
+/**
+ * Writes replay records to disk from a background thread.
+ *
+ * Records are pushed to a queue bounded to maxQueueBytes, only
+ * holding the present robots, then encoded and written by batches,
+ * the file being flushed every flushBytes or flushMs
+ */
+class LogWriter
+{
+public:
+  struct Stats
+  {
+    // Records waiting to be written
+    size_t queueDepth;
+    // Records written and dropped because the queue was full
+    size_t records;
+    size_t dropped;
+    // Bytes written to the file
+    size_t bytesWritten;
+    // Duration of the last and longest flush [ms]
+    double lastFlushMs;
+    double maxFlushMs;
+  };
+
+  LogWriter(size_t maxQueueBytes = 16 * 1024 * 1024, size_t flushBytes = 64 * 1024, double flushMs = 200);
+  ~LogWriter();
+
+  bool open(const std::string& filename);
+
+  /**
+   * Queue a record for writing. Never blocks, return false
+   * if the queue is full and the record was dropped
+   */
+  bool push(const ReplayFrame& frame);
+
+  /**
+   * Write all pending records and close the file
+   */
+  void close();
+
+  Stats getStats() const;
+
+protected:
+  /**
+   * Queued record, the robots being copied out of the dense table
+   */
+  struct Pending
+  {
+    double time;
+    size_t frame;
+    std::vector<rhoban_team_play::TeamPlayInfo> robots;
+    rhoban_team_play::CaptainInfo captainInfo;
+  };
+
+  static size_t sizeOf(const Pending& pending);
+
+  void run();
+
+  /**
+   * Write the pending buffer to the file and flush it
+   */
+  void commit();
+
+  size_t maxQueueBytes;
+  size_t flushBytes;
+  double flushMs;
+
+  std::ofstream file;
+  std::string buffer;
+  ReplayEncoder encoder;
+  // Frame rebuilt from the queued records for the encoder
+  ReplayFrame current;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<Pending> queue;
+  size_t queueBytes;
+  bool stopping;
+  std::thread* thread;
+
+  std::atomic<size_t> queueDepth;
+  std::atomic<size_t> records;
+  std::atomic<size_t> dropped;
+  std::atomic<size_t> bytesWritten;
+  std::atomic<double> lastFlushMs;
+  std::atomic<double> maxFlushMs;
+};
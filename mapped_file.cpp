@@ -0,0 +1,92 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapped_file.h"
+
+MappedFile::MappedFile() : mapping(nullptr), length(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+static int adviceOf(MappedFile::Access access)
+{
+  switch (access)
+  {
+    case MappedFile::Sequential:
+      return MADV_SEQUENTIAL;
+    case MappedFile::Random:
+      return MADV_RANDOM;
+    default:
+      return MADV_NORMAL;
+  }
+}
+
+bool MappedFile::open(const std::string& filename, Access access)
+{
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  // Empty files can't be mapped but are valid
+  if (st.st_size > 0)
+  {
+    void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED)
+    {
+      ::close(fd);
+      return false;
+    }
+    mapping = (const char*)ptr;
+    length = st.st_size;
+    advise(access);
+  }
+
+  // The mapping stays valid after closing the descriptor
+  ::close(fd);
+
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (mapping != nullptr)
+  {
+    munmap((void*)mapping, length);
+    mapping = nullptr;
+    length = 0;
+  }
+}
+
+void MappedFile::advise(Access access)
+{
+  if (mapping != nullptr)
+  {
+    madvise((void*)mapping, length, adviceOf(access));
+  }
+}
+
+const char* MappedFile::data() const
+{
+  return mapping;
+}
+
+size_t MappedFile::size() const
+{
+  return length;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Read only memory mapping of a whole file
+ */
+class MappedFile
+{
+public:
+  /**
+   * Expected access to the mapping, given to the kernel to tune its
+   * read ahead. Sequential also lets it drop the pages once read
+   */
+  enum Access
+  {
+    Normal,
+    Sequential,
+    Random
+  };
+
+  MappedFile();
+  ~MappedFile();
+
+  bool open(const std::string& filename, Access access = Normal);
+  void close();
+
+  /**
+   * Change the expected access, e.g. once a scan is over
+   */
+  void advise(Access access);
+
+  const char* data() const;
+  size_t size() const;
+
+protected:
+  // Not copyable, the mapping is owned
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+  const char* mapping;
+  size_t length;
+};
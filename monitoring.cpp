@@ -6,7 +6,9 @@
 #include <fstream>
 #include <thread>
 #include <chrono>
-#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <sys/stat.h>
 #include <SFML/Window.hpp>
 #include <SFML/Graphics.hpp>
 #include <rhoban_geometry/point.h>
@@ -19,54 +21,69 @@
 
 #include "RichText.hpp"
 #include "log.h"
+#include "ingest.h"
+#include "replay.h"
+#include "replay_store.h"
+#include "replay_clock.h"
+#include "log_writer.h"
+#include "shape_batch.h"
+#include "robot_panel.h"
+#include "robot_table.h"
+#include "heatmap.h"
+#include "trail.h"
+#include "parallel.h"
 
 #ifdef USE_CAMERA
 #include <opencv2/opencv.hpp>
+#include "frame_ring.h"
+#include "frame_encoder.h"
+#include "frame_store.h"
+#include "frame_prefetch.h"
+#include "camera_view.h"
 
 using namespace cv;
 #endif
 
 using namespace rhoban_utils;
 using namespace rhoban_team_play;
-static bool stopped = false;
-std::string refereeIp = "";
-bool badRefereeIp = false;
+static std::atomic<bool> stopped(false);
 
 int globalAlpha = 255;
 sf::Font font;
+// Names and colors of the robots
+RobotTable robotTable;
 
 /**
- * Draw between given point a RoboCup line
+ * Add between given point a RoboCup line
  */
-void drawLine(sf::RenderWindow& window, const sf::Vector2f& p1, const sf::Vector2f& p2)
+void addFieldLine(ShapeBatch& field, const sf::Vector2f& p1, const sf::Vector2f& p2)
 {
   // Horizontal line
   if (fabs(p1.x - p2.x) > fabs(p1.y - p2.y))
   {
     double sizeX = fabs(p1.x - p2.x);
     double sizeY = 0.05;
-    sf::RectangleShape shape(sf::Vector2f(sizeX, sizeY));
-    shape.move(sf::Vector2f(-sizeX / 2.0, -sizeY / 2.0));
-    shape.move(sf::Vector2f(0.5 * p1.x + 0.5 * p2.x, 0.5 * p1.y + 0.5 * p2.y));
-    window.draw(shape);
+    field.addRectangle(sf::Vector2f(sizeX, sizeY), sf::Vector2f(sizeX / 2.0, sizeY / 2.0),
+                       sf::Vector2f(0.5 * p1.x + 0.5 * p2.x, 0.5 * p1.y + 0.5 * p2.y), 0, sf::Color::White);
   }
   // Vertical line
   else
   {
     double sizeX = 0.05;
     double sizeY = fabs(p1.y - p2.y);
-    sf::RectangleShape shape(sf::Vector2f(sizeX, sizeY));
-    shape.move(sf::Vector2f(-sizeX / 2.0, -sizeY / 2.0));
-    shape.move(sf::Vector2f(0.5 * p1.x + 0.5 * p2.x, 0.5 * p1.y + 0.5 * p2.y));
-    window.draw(shape);
+    field.addRectangle(sf::Vector2f(sizeX, sizeY), sf::Vector2f(sizeX / 2.0, sizeY / 2.0),
+                       sf::Vector2f(0.5 * p1.x + 0.5 * p2.x, 0.5 * p1.y + 0.5 * p2.y), 0, sf::Color::White);
   }
 }
 
 /**
- * Draw the RoboCup field
+ * Build the RoboCup field lines, which never change and are
+ * drawn as a single batch
  */
-void drawField(sf::RenderWindow& window)
+void buildField(ShapeBatch& field)
 {
+  field.clear();
+
   double fieldWidth = robocup_referee::Constants::field.fieldLength;
   double fieldHeight = robocup_referee::Constants::field.fieldWidth;
   double goalWidth = robocup_referee::Constants::field.goalWidth;
@@ -74,42 +91,38 @@ void drawField(sf::RenderWindow& window)
   double goalAreaDepth = robocup_referee::Constants::field.goalAreaLength;
   double goalAreaWidth = robocup_referee::Constants::field.goalAreaWidth;
 
-  drawLine(window, sf::Vector2f(-fieldWidth / 2, -fieldHeight / 2), sf::Vector2f(fieldWidth / 2, -fieldHeight / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2, fieldHeight / 2), sf::Vector2f(fieldWidth / 2, fieldHeight / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2, fieldHeight / 2), sf::Vector2f(-fieldWidth / 2, -fieldHeight / 2));
-  drawLine(window, sf::Vector2f(fieldWidth / 2, fieldHeight / 2), sf::Vector2f(fieldWidth / 2, -fieldHeight / 2));
-  drawLine(window, sf::Vector2f(0.0, fieldHeight / 2), sf::Vector2f(0.0, -fieldHeight / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2, -goalAreaWidth / 2),
-           sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, -goalAreaWidth / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2, goalAreaWidth / 2),
-           sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, goalAreaWidth / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, -goalAreaWidth / 2),
-           sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, goalAreaWidth / 2));
-  drawLine(window, sf::Vector2f(fieldWidth / 2, -goalAreaWidth / 2),
-           sf::Vector2f(fieldWidth / 2 - goalAreaDepth, -goalAreaWidth / 2));
-  drawLine(window, sf::Vector2f(fieldWidth / 2, goalAreaWidth / 2),
-           sf::Vector2f(fieldWidth / 2 - goalAreaDepth, goalAreaWidth / 2));
-  drawLine(window, sf::Vector2f(fieldWidth / 2 - goalAreaDepth, -goalAreaWidth / 2),
-           sf::Vector2f(fieldWidth / 2 - goalAreaDepth, goalAreaWidth / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2, -goalWidth / 2),
-           sf::Vector2f(-fieldWidth / 2 - goalDepth, -goalWidth / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2, goalWidth / 2),
-           sf::Vector2f(-fieldWidth / 2 - goalDepth, goalWidth / 2));
-  drawLine(window, sf::Vector2f(-fieldWidth / 2 - goalDepth, -goalWidth / 2),
-           sf::Vector2f(-fieldWidth / 2 - goalDepth, goalWidth / 2));
-  drawLine(window, sf::Vector2f(fieldWidth / 2, -goalWidth / 2),
-           sf::Vector2f(fieldWidth / 2 + goalDepth, -goalWidth / 2));
-  drawLine(window, sf::Vector2f(fieldWidth / 2, goalWidth / 2),
-           sf::Vector2f(fieldWidth / 2 + goalDepth, goalWidth / 2));
-  drawLine(window, sf::Vector2f(fieldWidth / 2 + goalDepth, -goalWidth / 2),
-           sf::Vector2f(fieldWidth / 2 + goalDepth, goalWidth / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2, -fieldHeight / 2), sf::Vector2f(fieldWidth / 2, -fieldHeight / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2, fieldHeight / 2), sf::Vector2f(fieldWidth / 2, fieldHeight / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2, fieldHeight / 2), sf::Vector2f(-fieldWidth / 2, -fieldHeight / 2));
+  addFieldLine(field, sf::Vector2f(fieldWidth / 2, fieldHeight / 2), sf::Vector2f(fieldWidth / 2, -fieldHeight / 2));
+  addFieldLine(field, sf::Vector2f(0.0, fieldHeight / 2), sf::Vector2f(0.0, -fieldHeight / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2, -goalAreaWidth / 2),
+               sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, -goalAreaWidth / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2, goalAreaWidth / 2),
+               sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, goalAreaWidth / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, -goalAreaWidth / 2),
+               sf::Vector2f(-fieldWidth / 2 + goalAreaDepth, goalAreaWidth / 2));
+  addFieldLine(field, sf::Vector2f(fieldWidth / 2, -goalAreaWidth / 2),
+               sf::Vector2f(fieldWidth / 2 - goalAreaDepth, -goalAreaWidth / 2));
+  addFieldLine(field, sf::Vector2f(fieldWidth / 2, goalAreaWidth / 2),
+               sf::Vector2f(fieldWidth / 2 - goalAreaDepth, goalAreaWidth / 2));
+  addFieldLine(field, sf::Vector2f(fieldWidth / 2 - goalAreaDepth, -goalAreaWidth / 2),
+               sf::Vector2f(fieldWidth / 2 - goalAreaDepth, goalAreaWidth / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2, -goalWidth / 2),
+               sf::Vector2f(-fieldWidth / 2 - goalDepth, -goalWidth / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2, goalWidth / 2),
+               sf::Vector2f(-fieldWidth / 2 - goalDepth, goalWidth / 2));
+  addFieldLine(field, sf::Vector2f(-fieldWidth / 2 - goalDepth, -goalWidth / 2),
+               sf::Vector2f(-fieldWidth / 2 - goalDepth, goalWidth / 2));
+  addFieldLine(field, sf::Vector2f(fieldWidth / 2, -goalWidth / 2),
+               sf::Vector2f(fieldWidth / 2 + goalDepth, -goalWidth / 2));
+  addFieldLine(field, sf::Vector2f(fieldWidth / 2, goalWidth / 2),
+               sf::Vector2f(fieldWidth / 2 + goalDepth, goalWidth / 2));
+  addFieldLine(field, sf::Vector2f(fieldWidth / 2 + goalDepth, -goalWidth / 2),
+               sf::Vector2f(fieldWidth / 2 + goalDepth, goalWidth / 2));
   // Central circle
   double radius = 1.5 / 2.0;
-  sf::CircleShape circle(radius);
-  circle.move(-radius, -radius);
-  circle.setFillColor(sf::Color::Transparent);
-  circle.setOutlineThickness(0.05);
-  window.draw(circle);
+  field.addRing(sf::Vector2f(0, 0), radius, 0.05, sf::Color::White);
 }
 
 /**
@@ -117,35 +130,8 @@ void drawField(sf::RenderWindow& window)
  */
 sf::Color getColor(int id)
 {
-  sf::Color color(200, 200, 200, globalAlpha);
-  if (id == 1)
-  {
-    color = sf::Color(210, 0, 255, globalAlpha);
-  }
-  if (id == 2)
-  {
-    color = sf::Color(0, 220, 0, globalAlpha);
-  }
-  if (id == 3)
-  {
-    color = sf::Color(0, 220, 220, globalAlpha);
-  }
-  if (id == 4)
-  {
-    color = sf::Color(220, 220, 0, globalAlpha);
-  }
-  if (id == 5)
-  {
-    color = sf::Color(255, 132, 0, globalAlpha);
-  }
-  if (id == 6)
-  {
-    color = sf::Color(72, 140, 224, globalAlpha);
-  }
-  if (id == 10)
-  {
-    color = sf::Color(255, 0, 0, globalAlpha);
-  }
+  sf::Color color = robotTable.get(id).color;
+  color.a = globalAlpha;
   return color;
 }
 
@@ -153,7 +139,7 @@ sf::Color getColor(int id)
  * Draw given string at given
  * position with id
  */
-void drawText(sf::RenderWindow& window, sfe::RichText& text, const sf::Vector2f& pos, int id)
+void drawText(sf::RenderTarget& target, sfe::RichText& text, const sf::Vector2f& pos, int id)
 {
   double size = 0.008;
   text.setFont(font);
@@ -161,59 +147,46 @@ void drawText(sf::RenderWindow& window, sfe::RichText& text, const sf::Vector2f&
   text.move(pos.x, -pos.y);
   text.scale(size, size);
   text.move(0.0, -size * 20.0);
-  window.draw(text);
+  target.draw(text);
 }
 
-void drawText(sf::RenderWindow& window, const std::string& str, const sf::Vector2f& pos, int id)
+void drawText(sf::RenderTarget& target, const std::string& str, const sf::Vector2f& pos, const sf::Color& color)
 {
   sfe::RichText text(font);
-  text << getColor(id) << str;
-  drawText(window, text, pos, id);
+  text << color << str;
+  drawText(target, text, pos, 0);
+}
+
+void drawText(sf::RenderTarget& target, const std::string& str, const sf::Vector2f& pos, int id)
+{
+  drawText(target, str, pos, getColor(id));
 }
 
 /**
  * Draw a ball at given position for
  * given player id
  */
-void drawBall(sf::RenderWindow& window, const sf::Vector2f& pos, int id)
+void drawBall(ShapeBatch& shapes, const sf::Vector2f& pos, int id)
 {
   double radius = 0.075;
-  sf::CircleShape circle(radius);
-  circle.setOrigin(radius, radius);
-  circle.move(pos.x, -pos.y);
-  circle.setFillColor(sf::Color::Transparent);
-  circle.setOutlineColor(getColor(id));
-  circle.setOutlineThickness(0.03);
-  window.draw(circle);
-
-  sf::CircleShape circle2(1.5 * radius);
-  circle2.setOrigin(1.5 * radius, 1.5 * radius);
-  circle2.move(pos.x, -pos.y);
-  circle2.setFillColor(sf::Color::Transparent);
-  circle2.setOutlineColor(getColor(id));
-  circle2.setOutlineThickness(0.03);
-  window.draw(circle2);
+  shapes.addRing(sf::Vector2f(pos.x, -pos.y), radius, 0.03, getColor(id));
+  shapes.addRing(sf::Vector2f(pos.x, -pos.y), 1.5 * radius, 0.03, getColor(id));
 }
 
-void drawAnyLine(sf::RenderWindow& window, const sf::Vector2f& from, const sf::Vector2f& to, int id,
-                 double thickness = 0.02)
+void drawAnyLine(ShapeBatch& shapes, const sf::Vector2f& from, const sf::Vector2f& to, int id, double thickness = 0.02)
 {
   auto diff = to - from;
   auto yaw = atan2(diff.y, diff.x);
   auto dist = sqrt(diff.x * diff.x + diff.y * diff.y);
 
-  sf::RectangleShape shape1(sf::Vector2f(dist, thickness));
-  shape1.setOrigin(0, thickness / 2);
-  shape1.rotate(-yaw * 180 / M_PI);
-  shape1.move(sf::Vector2f(from.x, -from.y));
-  shape1.setFillColor(getColor(id));
-  window.draw(shape1);
+  shapes.addRectangle(sf::Vector2f(dist, thickness), sf::Vector2f(0, thickness / 2), sf::Vector2f(from.x, -from.y),
+                      -yaw * 180 / M_PI, getColor(id));
 }
 
 /**
  * Draws the ball arrow to its target
  */
-void drawBallArrow(sf::RenderWindow& window, const sf::Vector2f& pos, const sf::Vector2f& target, int id)
+void drawBallArrow(ShapeBatch& shapes, const sf::Vector2f& pos, const sf::Vector2f& target, int id)
 {
   auto diff = target - pos;
   auto yaw = atan2(diff.y, diff.x) * 180 / M_PI;
@@ -236,68 +209,49 @@ void drawBallArrow(sf::RenderWindow& window, const sf::Vector2f& pos, const sf::
   b = transform.transformPoint(b);
   base = transform.transformPoint(base);
 
-  drawAnyLine(window, pos, pos + base, id);
-  drawAnyLine(window, pos + a, pos + base, id);
-  drawAnyLine(window, pos + b, pos + base, id);
-  drawAnyLine(window, pos + a, target, id);
-  drawAnyLine(window, pos + b, target, id);
+  drawAnyLine(shapes, pos, pos + base, id);
+  drawAnyLine(shapes, pos + a, pos + base, id);
+  drawAnyLine(shapes, pos + b, pos + base, id);
+  drawAnyLine(shapes, pos + a, target, id);
+  drawAnyLine(shapes, pos + b, target, id);
 }
 
 /**
  * Draw a RoboCup player at given pose
  */
-void drawPlayer(sf::RenderWindow& window, const sf::Vector2f& pos, double yaw, int id)
+void drawPlayer(ShapeBatch& shapes, const sf::Vector2f& pos, double yaw, int id)
 {
   double sizeX = 0.15;
   double sizeY = 0.30;
-  sf::RectangleShape shape1(sf::Vector2f(sizeX, sizeY));
-  shape1.setOrigin(sizeX / 2.0, sizeY / 2.0);
-  shape1.rotate(-yaw);
-  shape1.move(sf::Vector2f(pos.x, -pos.y));
-  shape1.setFillColor(getColor(id));
-  window.draw(shape1);
-
-  sf::RectangleShape shape2(sf::Vector2f(sizeX, sizeY / 4.0));
-  shape2.setOrigin(0.0, sizeY / 8.0);
-  shape2.rotate(-yaw);
-  shape2.move(sf::Vector2f(pos.x, -pos.y));
-  shape2.setFillColor(getColor(id));
-  window.draw(shape2);
-
-  sf::RectangleShape shape3(sf::Vector2f(1.5 * sizeX, sizeY / 10.0));
-  shape3.setOrigin(0.0, sizeY / 20.0);
-  shape3.rotate(-yaw);
-  shape3.move(sf::Vector2f(pos.x, -pos.y));
-  shape3.setFillColor(getColor(id));
-  window.draw(shape3);
+  sf::Vector2f position(pos.x, -pos.y);
+  shapes.addRectangle(sf::Vector2f(sizeX, sizeY), sf::Vector2f(sizeX / 2.0, sizeY / 2.0), position, -yaw, getColor(id));
+  shapes.addRectangle(sf::Vector2f(sizeX, sizeY / 4.0), sf::Vector2f(0.0, sizeY / 8.0), position, -yaw, getColor(id));
+  shapes.addRectangle(sf::Vector2f(1.5 * sizeX, sizeY / 10.0), sf::Vector2f(0.0, sizeY / 20.0), position, -yaw,
+                      getColor(id));
 }
 
-void drawDashedLine(sf::RenderWindow& window, rhoban_geometry::Point pt1, rhoban_geometry::Point pt2, int id)
+void drawDashedLine(ShapeBatch& shapes, rhoban_geometry::Point pt1, rhoban_geometry::Point pt2, int id)
 {
   double delta = 0.1;
   while ((pt2 - pt1).getLength() > delta)
   {
     rhoban_geometry::Point target = pt1 + (pt2 - pt1).normalize(delta / 2);
-    drawAnyLine(window, sf::Vector2f(pt1.x, pt1.y), sf::Vector2f(target.x, target.y), id);
+    drawAnyLine(shapes, sf::Vector2f(pt1.x, pt1.y), sf::Vector2f(target.x, target.y), id);
     pt1 = pt1 + (pt2 - pt1).normalize(delta);
   }
 }
 
-void drawObstacle(sf::RenderWindow& window, const sf::Vector2f& pos, double radius, int id, int alpha)
+void drawObstacle(ShapeBatch& shapes, const sf::Vector2f& pos, double radius, int id, int alpha)
 {
   globalAlpha = alpha;
-  sf::CircleShape circle(radius);
-  circle.setOrigin(radius, radius);
-  circle.move(pos.x, -pos.y);
-  circle.setFillColor(getColor(id));
-  window.draw(circle);
+  shapes.addDisc(sf::Vector2f(pos.x, -pos.y), radius, getColor(id));
   globalAlpha = 255;
 }
 
 /**
  * Drawing target for placing
  */
-void drawTarget(sf::RenderWindow& window, const sf::Vector2f& pos, const sf::Vector2f& localTarget,
+void drawTarget(ShapeBatch& shapes, const sf::Vector2f& pos, const sf::Vector2f& localTarget,
                 const sf::Vector2f& target, int id)
 {
   double sizeX = 0.1;
@@ -307,151 +261,549 @@ void drawTarget(sf::RenderWindow& window, const sf::Vector2f& pos, const sf::Vec
   rhoban_geometry::Point pt2(localTarget.x, localTarget.y);
   rhoban_geometry::Point pt3(target.x, target.y);
 
-  drawDashedLine(window, pt, pt2, id);
+  drawDashedLine(shapes, pt, pt2, id);
   globalAlpha = 100;
-  drawDashedLine(window, pt2, pt3, id);
+  drawDashedLine(shapes, pt2, pt3, id);
   globalAlpha = 255;
 
   for (int angle : { -45, 45 })
   {
-    sf::RectangleShape shape1(sf::Vector2f(sizeX, sizeY));
-    shape1.setOrigin(sizeX / 2.0, sizeY / 2.0);
-    shape1.rotate(angle);
-    shape1.move(sf::Vector2f(localTarget.x, -localTarget.y));
-    shape1.setFillColor(getColor(id));
-    window.draw(shape1);
-
-    sf::RectangleShape shape2(sf::Vector2f(sizeX * 2, sizeY * 2));
-    shape2.setOrigin(sizeX * 2 / 2.0, sizeY * 2 / 2.0);
-    shape2.rotate(angle);
-    shape2.move(sf::Vector2f(target.x, -target.y));
-    shape2.setFillColor(getColor(id));
-    window.draw(shape2);
+    shapes.addRectangle(sf::Vector2f(sizeX, sizeY), sf::Vector2f(sizeX / 2.0, sizeY / 2.0),
+                        sf::Vector2f(localTarget.x, -localTarget.y), angle, getColor(id));
+    shapes.addRectangle(sf::Vector2f(sizeX * 2, sizeY * 2), sf::Vector2f(sizeX * 2 / 2.0, sizeY * 2 / 2.0),
+                        sf::Vector2f(target.x, -target.y), angle, getColor(id));
   }
 }
 
 /**
- * Read and load from given opened file
- * log and fill given data structure.
- * Return false on file end.
+ * Pose of a robot and position of its ball on the displayed field
  */
-bool loadReplayLine(std::ifstream& replay, std::map<int, TeamPlayInfo>& allInfo, CaptainInfo& captainInfo,
-                    double* replayTime = nullptr, size_t* framePtr = nullptr)
+void robotPose(const TeamPlayInfo& info, int isInverted, sf::Vector2f& robotPos, double& yaw, sf::Vector2f& ballPos)
 {
-  // Check file end
-  if (!replay.good() || replay.peek() == EOF)
+  yaw = info.fieldYaw;
+  robotPos = sf::Vector2f(info.fieldX, info.fieldY);
+  // Invert field orientation
+  if (isInverted == -1)
   {
-    return false;
+    yaw += M_PI;
   }
+  robotPos.x *= isInverted;
+  robotPos.y *= isInverted;
+  // Compute ball positionin world
+  ballPos = sf::Vector2f(cos(yaw) * info.ballX - sin(yaw) * info.ballY, sin(yaw) * info.ballX + cos(yaw) * info.ballY);
+  ballPos += robotPos;
+}
 
-  // Peeking the next line
-  std::string line;
-  std::getline(replay, line);
+#ifdef USE_CAMERA
+// Last captured frame number
+std::atomic<size_t> lastFrame(0);
+
+// Recent frames, shared by the live view and the recording
+FrameRing frameRing;
 
-  Json::Reader reader;
-  Json::Value json;
+void captureThread()
+{
+  size_t n = 0;
+  std::cout << "Capturing on camera #" << CAMERA << std::endl;
+  VideoCapture cap(CAMERA);
 
-  // Trying to parse
-  if (reader.parse(line, json))
+  while (!stopped)
   {
-    if (json.isMember("ts") && json.isMember("frame"))
+    if (cap.isOpened())
     {
-      if (replayTime != nullptr)
+      n++;
+      Mat frame;
+      cap >> frame;
+
+      // Stamped as soon as grabbed, on the clock of the team state samples
+      double time = TimeStamp::now().getTimeMS();
+      if (!frame.empty())
       {
-        *replayTime = json["ts"].asFloat();
+        frameRing.push(n, time, frame);
+        lastFrame = n;
       }
-      if (framePtr != nullptr)
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+  }
+  frameRing.stop();
+}
+
+/**
+ * Persists the frames of the ring, at most one every RECORD_PERIOD
+ * [ms], the encoding being done by the pool so that a slow encode
+ * never holds back the next frames
+ */
+void recordThread(FrameEncoder* encoder)
+{
+  uint64_t cursor = 0;
+  CameraFrame frame;
+  double lastRecord = 0;
+  bool hasRecord = false;
+
+  while (!stopped)
+  {
+    if (frameRing.next(cursor, frame, 100))
+    {
+      if (hasRecord && frame.time - lastRecord < RECORD_PERIOD)
       {
-        *framePtr = json["frame"].asInt();
+        continue;
       }
+      lastRecord = frame.time;
+      hasRecord = true;
+      encoder->push(frame);
+    }
+  }
+}
+#endif
 
-      for (auto& infoJson : json["info"])
+/**
+ * Heatmaps of the ball and of each robot and trail of the ball,
+ * accumulated in field coordinates as the displayed state advances
+ */
+struct Overlays
+{
+  Overlays()
+    : ball(fieldArea().x, fieldArea().y, cellSize, sf::Color(255, 255, 255)), ballTrail(300, 0.05), hasLastTime(false)
+  {
+    for (int id = 0; id < MAX_ROBOTS; id++)
+    {
+      robots.push_back(Heatmap(fieldArea().x, fieldArea().y, cellSize, getColor(id)));
+    }
+  }
+
+  /**
+   * Field and its surroundings, where robots can be
+   */
+  static sf::Vector2f fieldArea()
+  {
+    return sf::Vector2f(robocup_referee::Constants::field.fieldLength + 2,
+                        robocup_referee::Constants::field.fieldWidth + 2);
+  }
+
+  void clear()
+  {
+    ball.clear();
+    for (Heatmap& heatmap : robots)
+    {
+      heatmap.clear();
+    }
+    ballTrail.clear();
+    hasLastTime = false;
+  }
+
+  /**
+   * Accumulate given state seen at given time [ms], weighted by the
+   * time since the previous one. States older than the last one are
+   * ignored, so that replaying backward does not count twice
+   */
+  void add(const TeamState& team, const CaptainInfo& captainInfo, double time)
+  {
+    if (hasLastTime && time <= lastTime)
+    {
+      return;
+    }
+    // Gaps in the data are not counted as time spent [s]
+    float weight = hasLastTime ? std::min(time - lastTime, 1000.0) / 1000.0 : 0;
+    lastTime = time;
+    hasLastTime = true;
+
+    for (const TeamPlayInfo& info : team)
+    {
+      if (!info.isPenalized() && time - info.timestamp <= 5000)
       {
-        TeamPlayInfo info;
-        teamPlayfromJson(info, infoJson);
-        allInfo[info.id] = info;
+        robots[info.id].add(sf::Vector2f(info.fieldX, info.fieldY), weight);
       }
-
-      captainFromJson(captainInfo, json["captain"]);
+    }
+    if (captainInfo.id > 0 && team.size() > 0)
+    {
+      sf::Vector2f ballPos(captainInfo.common_ball.x, captainInfo.common_ball.y);
+      ball.add(ballPos, weight);
+      ballTrail.add(ballPos);
     }
   }
 
-  return true;
+  // Heatmaps resolution [m]
+  static constexpr double cellSize = 0.1;
+
+  Heatmap ball;
+  std::vector<Heatmap> robots;
+  Trail ballTrail;
+  double lastTime;
+  bool hasLastTime;
+};
+
+/**
+ * Position [m] of the top left corner and scale of the k-th of n info
+ * panels. They are laid out in columns on both sides of the field, up
+ * to 3 per column at full size, and shrunk until all of them fit
+ */
+void panelSlot(size_t k, size_t n, sf::Vector2f& pos, double& scale)
+{
+  // Shrinking by shrink fits shrink columns of 3 * shrink panels per side
+  size_t shrink = 1;
+  while (2 * shrink * 3 * shrink < n)
+  {
+    shrink++;
+  }
+  scale = 1.0 / shrink;
+
+  size_t rows = 3 * shrink;
+  size_t column = k / rows;
+  size_t row = k % rows;
+  bool isRight = column >= shrink;
+  pos.x = (isRight ? 4.75 : -6.5) + (column % shrink) * 2.0 * scale;
+  pos.y = 3.0 - row * 2.25 * scale;
 }
 
-size_t currentFrame = 0;
+/**
+ * State shown by one frame of the field view
+ */
+struct Scene
+{
+  const TeamState* team;
+  const CaptainInfo* captainInfo;
+  std::string refereeIp;
+  bool badRefereeIp;
+  int isInverted;
+  // Time [ms] at which the age of the robots information is computed
+  double time;
+  // Replay position [ms] from its start and speed, shown when replaying
+  bool isReplay;
+  double replayPosition;
+  double replaySpeed;
+  // Overlays to draw if not NULL, and which of them are shown
+  const Overlays* overlays;
+  bool showHeatmaps;
+  bool showTrails;
+};
 
-#ifdef USE_CAMERA
-size_t lastFrame = 0;
-bool hasNewFrame = false;
-std::mutex frameMutex;
+/**
+ * Drawables kept from one frame of the field view to the next
+ */
+struct SceneCache
+{
+  SceneCache(const sf::Texture& logo) : logoSprite(logo), logoInverted(0), panels(MAX_ROBOTS)
+  {
+    logoSprite.setColor(sf::Color(255, 255, 255, 100));
+    logoSprite.setOrigin(sf::Vector2f(773 / 2.0, 960 / 2.0));
+    logoSprite.scale(0.0035, 0.0035);
+    buildField(field);
+  }
 
-void captureThread()
+  sf::Sprite logoSprite;
+  int logoInverted;
+  // Field lines, in field coordinates so that they don't depend on the view
+  ShapeBatch field;
+  // Dynamic shapes, refilled each frame
+  ShapeBatch shapes;
+  // Info panels, by robot id
+  std::vector<RobotPanel> panels;
+};
+
+/**
+ * Draw the field, robots and their info on given target, in
+ * field coordinates (the view of the target is already set)
+ */
+void drawScene(sf::RenderTarget& target, const Scene& scene, SceneCache& cache)
 {
-  size_t n = 0;
-  std::cout << "Capturing on camera #" << CAMERA << std::endl;
-  VideoCapture cap(CAMERA);
-  auto last = TimeStamp::now();
+  const TeamState* team = scene.team;
+  const CaptainInfo* captainInfo = scene.captainInfo;
+  int isInverted = scene.isInverted;
 
-  while (!stopped)
+  // Draw logo, only placed again when the field is inverted
+  if (cache.logoInverted != isInverted)
   {
-    if (cap.isOpened())
+    cache.logoInverted = isInverted;
+    cache.logoSprite.setPosition(isInverted * -2.1, 0.2);
+  }
+  target.draw(cache.logoSprite, sf::RenderStates::Default);
+  // Draw RoboCup field
+  target.draw(cache.field);
+
+  // Draw heatmaps, turned with the field
+  const Overlays* overlays = scene.overlays;
+  if (overlays != NULL && scene.showHeatmaps)
+  {
+    sf::Transform inversion;
+    inversion.scale(isInverted, isInverted);
+    for (const Heatmap& heatmap : overlays->robots)
     {
-      n++;
-      Mat frame;
-      cap >> frame;
+      target.draw(heatmap, sf::RenderStates(inversion));
+    }
+    target.draw(overlays->ball, sf::RenderStates(inversion));
+  }
+
+  // Draw referee IP
+  if (scene.refereeIp != "")
+  {
+    sf::Color color = scene.badRefereeIp ? sf::Color(255, 0, 0) : sf::Color(0, 220, 0);
+    drawText(target, scene.refereeIp, sf::Vector2f(-0.75, 3.5), color);
+  }
+
+  // Robots, balls, targets and obstacles are all drawn as one batch
+  ShapeBatch& shapes = cache.shapes;
+  shapes.clear();
+
+  // Draw ball trail, fading out with its age
+  if (overlays != NULL && scene.showTrails)
+  {
+    const Trail& trail = overlays->ballTrail;
+    for (size_t k = 1; k < trail.size(); k++)
+    {
+      globalAlpha = 40 + 215 * k / trail.size();
+      drawAnyLine(shapes, trail.get(k - 1) * (float)isInverted, trail.get(k) * (float)isInverted, 0, 0.03);
+    }
+    globalAlpha = 255;
+  }
 
-      auto frameTs = TimeStamp::now();
+  for (const TeamPlayInfo& info : *team)
+  {
+    size_t id = info.id;
+    double yaw;
+    sf::Vector2f robotPos, ballPos;
+    robotPose(info, isInverted, robotPos, yaw, ballPos);
+    double age = (scene.time - info.timestamp) / 1000.0;
+    if (info.isPenalized() || age > 5.0)
+    {
+      // Along the side line, by rows of 20 robots
+      size_t place = robotTable.getIndex(id);
+      double x = isInverted * (-robocup_referee::Constants::field.fieldLength / 2);
+      x += isInverted * 0.45 * (place % 20);
+      double y = isInverted * (-robocup_referee::Constants::field.fieldWidth / 2 - 0.3 - 0.4 * (place / 20));
+      drawPlayer(shapes, sf::Vector2f(x, y), isInverted * 90.0, id);
+    }
+    else
+    {
+      drawPlayer(shapes, sf::Vector2f(robotPos.x, robotPos.y), yaw * 180.0 / M_PI, id);
+    }
+    if (info.ballQ > 0.0)
+    {
+      if (info.state != BallHandling)
+      {
+        globalAlpha = 100;
+      }
+      drawBall(shapes, ballPos, id);
+      globalAlpha = 255;
 
-      if (frameTs.getTimeMS() - last.getTimeMS() > 150)
+      if (info.state == BallHandling || info.state == Playing)
       {
-        last = frameTs;
-        lastFrame = n;
-        std::stringstream ss;
-        ss << "frame_" << n << ".jpeg";
-        imwrite(ss.str(), frame);
+        if (std::string(info.statePlaying) == "approach" || std::string(info.statePlaying) == "walkBall")
+        {
+          sf::Vector2f ballTarget(info.ballTargetX * isInverted, info.ballTargetY * isInverted);
+          drawBallArrow(shapes, ballPos, ballTarget, id);
+        }
+      }
+    }
+
+    // Draw placing target
+    if (info.placing)
+    {
+      drawTarget(shapes, sf::Vector2f(robotPos.x, robotPos.y),
+                 sf::Vector2f(info.localTargetX * isInverted, info.localTargetY * isInverted),
+                 sf::Vector2f(info.targetX * isInverted, info.targetY * isInverted), id);
+    }
+  }
+
+  // Draw consensus ball
+  bool hasConsensusBall = captainInfo->id > 0 && team->size() > 0;
+  sf::Vector2f consensusBallPos(captainInfo->common_ball.x * isInverted, captainInfo->common_ball.y * isInverted);
+  if (hasConsensusBall)
+  {
+    drawBall(shapes, consensusBallPos, 0);
+  }
+
+  // Draw obstacles
+  for (int k = 0; k < captainInfo->nb_opponents; k++)
+  {
+    auto& opponent = captainInfo->common_opponents[k];
+    int alpha = 60 + opponent.consensusStrength * 50;
+    if (alpha > 255)
+    {
+      alpha = 255;
+    }
 
-        frameMutex.lock();
-        hasNewFrame = true;
-        frameMutex.unlock();
+    drawObstacle(shapes, sf::Vector2f(opponent.x * isInverted, opponent.y * isInverted), 0.6, 0, alpha);
+  }
+  target.draw(shapes);
+
+  // Texts are drawn over the shapes
+  if (hasConsensusBall)
+  {
+    std::stringstream ssBall;
+    ssBall << captainInfo->common_ball.nbRobots;
+    drawText(target, ssBall.str(), consensusBallPos + sf::Vector2f(0.0, 0.35), 0);
+  }
+
+  // Draw balls quality
+  for (const TeamPlayInfo& info : *team)
+  {
+    size_t id = info.id;
+    double yaw;
+    sf::Vector2f robotPos, ballPos;
+    robotPose(info, isInverted, robotPos, yaw, ballPos);
+    if (info.ballQ > 0.0)
+    {
+      if (info.state != BallHandling)
+      {
+        globalAlpha = 100;
       }
+      std::stringstream ssBall;
+      ssBall << std::fixed << std::setprecision(2) << info.ballQ;
+      drawText(target, ssBall.str(), ballPos - sf::Vector2f(0.0, 0.35), id);
+      globalAlpha = 255;
     }
-    else
+  }
+
+  // Draw players info, in the robots layout order
+  size_t index = 0;
+  for (int id : robotTable.getOrder())
+  {
+    if (!team->has(id))
     {
-      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      continue;
     }
+    const TeamPlayInfo& info = team->get(id);
+    double age = (scene.time - info.timestamp) / 1000.0;
+
+    // Print information, the panel text is only rebuilt when it changes
+    const RobotStyle& style = robotTable.get(id);
+    RobotPanel& panel = cache.panels[id];
+    panel.update(info, style.name, getColor(id), captainInfo->id == info.id, age, font);
+
+    sf::Vector2f pos;
+    double scale;
+    panelSlot(index, team->size(), pos, scale);
+    panel.draw(target, pos, scale);
+    index++;
+  }
+
+  if (scene.isReplay)
+  {
+    std::stringstream ssTime;
+    ssTime << "Time: " << std::fixed << std::setprecision(2) << scene.replayPosition / 1000.0 << "s";
+    if (scene.replaySpeed != 1)
+    {
+      ssTime << " (x" << std::setprecision(3) << scene.replaySpeed << ")";
+    }
+    drawText(target, ssTime.str(), sf::Vector2f(0.0, 3.5), 0);
   }
 }
 
-void showThread()
+/**
+ * Render the replay between from and to [ms] headless, at fps frames
+ * per second of match time and as fast as possible. The frames go to a
+ * video when output ends with .avi (camera support only), or else to
+ * numbered PNG images in the output directory
+ */
+int renderReplay(ReplayStore& store, double from, double to, double fps, const std::string& output,
+                 const sf::Vector2u& size, const sf::View& view, SceneCache& cache)
 {
-  size_t frame = 0;
-  namedWindow("Frames", CV_WINDOW_NORMAL | CV_WINDOW_KEEPRATIO);
+  // Offscreen target, works as well on a software OpenGL implementation
+  sf::RenderTexture texture;
+  if (!texture.create(size.x, size.y))
+  {
+    std::cerr << "Can't create the render texture" << std::endl;
+    return 1;
+  }
+  texture.setView(view);
 
-  while (!stopped)
+  bool isVideo = output.size() > 4 && output.substr(output.size() - 4) == ".avi";
+#ifdef USE_CAMERA
+  VideoWriter video;
+  if (isVideo && !video.open(output, VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, Size(size.x, size.y)))
   {
-    if (currentFrame && frame != currentFrame)
+    std::cerr << "Can't write video to " << output << std::endl;
+    return 1;
+  }
+#else
+  if (isVideo)
+  {
+    std::cerr << "Video output requires the camera support (USE_CAMERA)" << std::endl;
+    return 1;
+  }
+#endif
+  if (!isVideo)
+  {
+    mkdir(output.c_str(), 0755);
+  }
+
+  size_t frames = std::floor((to - from) * fps / 1000.0) + 1;
+  std::cout << "Rendering " << frames << " frames to " << output << std::endl;
+  auto begin = std::chrono::steady_clock::now();
+
+  // Frames are rendered by batches, read back from the GPU on this
+  // thread and then encoded on all cores
+  size_t batchSize = std::max<size_t>(1, 2 * std::thread::hardware_concurrency());
+  std::vector<sf::Image> images(batchSize);
+  std::atomic<bool> failed(false);
+  for (size_t first = 0; first < frames && !failed; first += batchSize)
+  {
+    size_t n = std::min(batchSize, frames - first);
+    for (size_t k = 0; k < n; k++)
     {
-      frame = currentFrame;
-      std::stringstream ss;
-      ss << "frame_" << frame << ".jpeg";
-      if (file_exists(ss.str()))
+      double time = from + (first + k) * 1000.0 / fps;
+      size_t index = store.indexAt(time);
+      std::shared_ptr<const ReplayFrame> sample = store.get(index);
+
+      Scene scene;
+      scene.team = &sample->team;
+      scene.captainInfo = &sample->captainInfo;
+      scene.badRefereeIp = false;
+      scene.isInverted = 1;
+      scene.time = store.getTime(index);
+      scene.isReplay = true;
+      scene.replayPosition = time - store.getTime(0);
+      scene.replaySpeed = 1;
+      scene.overlays = NULL;
+
+      texture.clear();
+      drawScene(texture, scene, cache);
+      texture.display();
+      images[k] = texture.getTexture().copyToImage();
+    }
+
+    if (isVideo)
+    {
+#ifdef USE_CAMERA
+      // The writer is sequential
+      for (size_t k = 0; k < n; k++)
       {
-        try
-        {
-          auto img = imread(ss.str());
-          imshow("Frames", img);
-        }
-        catch (cv::Exception)
+        Mat rgba(size.y, size.x, CV_8UC4, (void*)images[k].getPixelsPtr());
+        Mat bgr;
+        cvtColor(rgba, bgr, COLOR_RGBA2BGR);
+        video.write(bgr);
+      }
+#endif
+    }
+    else
+    {
+      parallelFor(n, [&](size_t k) {
+        std::stringstream ss;
+        ss << output << "/frame_" << std::setfill('0') << std::setw(6) << first + k << ".png";
+        if (!images[k].saveToFile(ss.str()))
         {
-          std::cerr << "Can't read " << ss.str() << std::endl;
+          failed = true;
         }
-      }
+      });
     }
-    waitKey(30);
+    std::cout << "\rRendering: " << (first + n) * 100 / frames << "%" << std::flush;
+  }
+  std::cout << std::endl;
+
+  if (failed)
+  {
+    std::cerr << "Can't write images to " << output << std::endl;
+    return 1;
   }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  std::cout << "Rendered " << frames << " frames (" << std::fixed << std::setprecision(1) << (to - from) / 1000.0
+            << "s of match) in " << elapsed << "s" << std::endl;
+
+  return 0;
 }
-#endif
 
 int main(int argc, char** argv)
 {
@@ -459,6 +811,7 @@ int main(int argc, char** argv)
   std::string binary_path = rhoban_utils::getDirName(argv[0]);
   std::string font_path = binary_path + "font.ttf";
   std::string img_path = binary_path + "RhobanFootballClub.png";
+  std::string robots_path = binary_path + "robots.json";
   std::cout << "Loading from : " << binary_path << std::endl;
 
   // UDP port
@@ -471,11 +824,46 @@ int main(int argc, char** argv)
   std::string replayFilename;
   uint8_t logRobot = 0;
   Log outLog;
+  // Headless rendering of the replay, with its output, frame rate and range [s]
+  std::string renderOutput;
+  double renderFps = 30;
+  double renderFrom = 0, renderTo = -1;
   if (argc == 1)
   {
     std::cout << "Starting UDP listening on " << port << std::endl;
     isReplay = false;
   }
+  else if (std::string(argv[1]) == "--render")
+  {
+    if (argc < 4)
+    {
+      std::cout << "Usage: ./MonitoringViewer --render log_replay output [fps] [from_s] [to_s]" << std::endl;
+      return 1;
+    }
+    replayFilename = argv[2];
+    renderOutput = argv[3];
+    if (argc >= 5)
+    {
+      renderFps = atof(argv[4]);
+    }
+    if (argc >= 6)
+    {
+      renderFrom = atof(argv[5]);
+    }
+    if (argc >= 7)
+    {
+      renderTo = atof(argv[6]);
+    }
+    if (renderFps <= 0)
+    {
+      std::cerr << "Invalid frame rate " << renderFps << std::endl;
+      return 1;
+    }
+    port = -1;
+    captainPort = -1;
+    isReplay = true;
+    std::cout << "Loading replay from " << replayFilename << std::endl;
+  }
   else if (argc >= 2)
   {
     replayFilename = argv[1];
@@ -490,79 +878,119 @@ int main(int argc, char** argv)
     captainPort = -1;
     isReplay = true;
     std::cout << "Loading replay from " << replayFilename << std::endl;
+    std::cout << "Replay controls: P pause, F fast, S super fast, B backward, Up/Down speed x2/x0.5, "
+              << "Home/End start/end, Left/Right -/+10s, 0-9 jump to 0-90%, H heatmaps, T ball trail" << std::endl;
   }
   else
   {
-    std::cout << "Usage: ./MonitoringViewer [log_replay] [out.log]" << std::endl;
+    std::cout << "Usage: ./MonitoringViewer [log_replay] [robot out.log]" << std::endl;
     return 1;
   }
 
-  // Initialize UDP communication in read only
-  UDPBroadcast broadcaster(port, -1);
-  UDPBroadcast captainBroadcaster(captainPort, -1);
-  UDPBroadcast refereeBroadcaster(3838, -1);
-  std::map<int, TeamPlayInfo> allInfo;
-  CaptainInfo captainInfo;
+  // State displayed by the current frame, pointing either to the last
+  // ingest snapshot or to the current replay sample, which are not copied
+  TeamSnapshot emptySnapshot;
+  const TeamState* team = &emptySnapshot.team;
+  const CaptainInfo* captainInfo = &emptySnapshot.captainInfo;
+  std::shared_ptr<const ReplayFrame> replaySample;
+  std::string refereeIp = "";
+  bool badRefereeIp = false;
+  Ingest* ingest = NULL;
+  size_t lastUpdates = 0;
   std::thread* capture = NULL;
-  std::thread* show = NULL;
+  std::thread* record = NULL;
+  // Camera frame recorded with the displayed state, and the
+  // monitoring time [ms] of this state
+  size_t currentFrame = 0;
+  double currentTime = 0;
+#ifdef USE_CAMERA
+  // Camera recording, all frames go to a single indexed container
+  std::string framesFilename = "frames.bin";
+  FrameWriter frameWriter;
+  FrameStore frameStore;
+  FramePrefetcher framePrefetcher(frameStore);
+  CameraView cameraView;
+  FrameEncoder frameEncoder([&frameWriter](const CameraFrame& frame, const std::vector<unsigned char>& jpeg) {
+    frameWriter.write(frame, jpeg);
+  });
+#endif
+
+  // Log file, written in live mode
+  std::string logFilename = "monitoring.log";
+  LogWriter log;
 
   // Load replay
-  std::vector<std::map<int, TeamPlayInfo>> replayContainerInfo;
-  std::vector<CaptainInfo> replayContainerCaptain;
-  std::vector<size_t> replayContainerFrame;
-  std::vector<double> replayContainerTime;
+  ReplayStore replayStore;
   if (isReplay)
   {
-    std::ifstream replayFile;
-    replayFile.open(replayFilename);
-    while (true)
-    {
-      std::map<int, TeamPlayInfo> tmpInfo;
-      CaptainInfo tmpCaptain;
-      double tmpTime;
-      size_t tmpFrame;
-      bool isOk = loadReplayLine(replayFile, tmpInfo, tmpCaptain, &tmpTime, &tmpFrame);
-      // End of replay
-      if (!isOk)
-      {
-        break;
-      }
-      else
+    int lastPercent = -1;
+    bool isOk = replayStore.open(replayFilename, [&lastPercent](double ratio) {
+      int percent = ratio * 100;
+      if (percent != lastPercent)
       {
-        replayContainerInfo.push_back(tmpInfo);
-        replayContainerTime.push_back(tmpTime);
-        replayContainerFrame.push_back(tmpFrame);
-        replayContainerCaptain.push_back(tmpCaptain);
+        lastPercent = percent;
+        std::cout << "\rIndexing replay: " << percent << "%" << std::flush;
       }
+    });
+    std::cout << std::endl;
+    if (!isOk)
+    {
+      std::cerr << "Can't open replay " << replayFilename << std::endl;
+      return 1;
+    }
+    if (replayStore.size() == 0)
+    {
+      std::cerr << "Replay " << replayFilename << " is empty" << std::endl;
+      return 1;
     }
-    replayFile.close();
   }
   else
   {
+    // Open log files, before any thread writes to them
+    std::ifstream ifs(logFilename);
+    if (ifs.good())
+    {
+      std::cerr << "File '" << logFilename << "' already exists! Erase it before if you want to start a new log."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
 #ifdef USE_CAMERA
-    // Running the capture thread
-    capture = new std::thread(captureThread);
+    std::ifstream framesIfs(framesFilename);
+    if (framesIfs.good())
+    {
+      std::cerr << "File '" << framesFilename << "' already exists! Erase it before if you want to start a new log."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
 #endif
-  }
-
+    std::cout << "Writing log to " << logFilename << std::endl;
+    if (!log.open(logFilename))
+    {
+      std::cerr << "Can't write log to " << logFilename << std::endl;
+      exit(EXIT_FAILURE);
+    }
 #ifdef USE_CAMERA
-  show = new std::thread(showThread);
+    if (!frameWriter.open(framesFilename))
+    {
+      std::cerr << "Can't write camera frames to " << framesFilename << std::endl;
+      exit(EXIT_FAILURE);
+    }
 #endif
 
-  // Replay user control
-  size_t replayIndex = 0;
-  bool replayIsPaused = false;
-  bool replayFast = false;
-  bool replaySuperFast = false;
-  bool replayBackward = false;
+    // Running the UDP ingest thread
+    ingest = new Ingest(port, captainPort, 3838);
+    ingest->start();
+#ifdef USE_CAMERA
+    // Running the capture thread and its recording
+    capture = new std::thread(captureThread);
+    frameEncoder.start();
+    record = new std::thread(recordThread, &frameEncoder);
+#endif
+  }
 
-  // SFML Window initialization
   const int width = 1600;
   const double ratio = 16.0 / 9.0;
   const int height = width / ratio;
-  sf::ContextSettings settings;
-  settings.antialiasingLevel = 8;
-  sf::RenderWindow window(sf::VideoMode(width, height), "MonitoringViewer", sf::Style::Default, settings);
   // Load font file
   if (!font.loadFromFile(font_path))
   {
@@ -575,35 +1003,106 @@ int main(int argc, char** argv)
     throw std::logic_error("MonitoringViewer fail to load logo");
   }
   logo.setSmooth(true);
+  // Load robots names and colors, robots being shown in grey without it
+  if (robotTable.load(robots_path))
+  {
+    std::cout << "Loaded robots from " << robots_path << std::endl;
+  }
+  // Field, shapes and panels kept between frames
+  SceneCache cache(logo);
   // Initialize the camera
   double viewWidth = 14.0;
   double viewHeight = viewWidth / ratio;
   sf::View view(sf::Vector2f(0.0, 0.0), sf::Vector2f(viewWidth, viewHeight));
-  window.setView(view);
 
-  // Is the field view inverted
-  int isInverted = 1;
+  if (renderOutput != "")
+  {
+    double start = replayStore.getTime(0);
+    double end = replayStore.getTime(replayStore.size() - 1);
+    double from = std::max(start, start + renderFrom * 1000);
+    double to = renderTo < 0 ? end : std::min(end, start + renderTo * 1000);
+    if (from > to)
+    {
+      std::cerr << "Empty render range" << std::endl;
+      return 1;
+    }
+    return renderReplay(replayStore, from, to, renderFps, renderOutput, sf::Vector2u(width, height), view, cache);
+  }
 
-  // Open log file
-  std::string logFilename = "monitoring.log";
-  std::ofstream log;
-  if (!isReplay)
+#ifdef USE_CAMERA
+  if (isReplay)
   {
-    std::ifstream ifs(logFilename);
-    if (ifs.good())
+    if (frameStore.open(framesFilename))
     {
-      std::cerr << "File '" << logFilename << "' already exists! Erase it before if you want to start a new log."
-                << std::endl;
-      exit(EXIT_FAILURE);
+      std::cout << "Loaded " << frameStore.size() << " camera frames from " << framesFilename << std::endl;
     }
-    std::cout << "Writing log to " << logFilename << std::endl;
-    log.open(logFilename);
+    framePrefetcher.start();
   }
-  else
+#endif
+
+  // Replay user control
+  size_t replayIndex = 0;
+  ReplayClock replayClock;
+  // Speed without the F, S and B modifiers
+  double replaySpeed = 1;
+  bool replaySeeked = false;
+
+  // Robot clock [ms of day] minus monitoring time [ms], to match out.log entries
+  double outLogOffset = 0;
+  bool outLogCalibrated = false;
+  // Largest gap between two packets of the robot to calibrate from [ms]
+  const double outLogCalibrationGap = 250;
+  uint32_t lastOutLogTime = 0;
+  bool hasOutLogTime = false;
+
+  // Jump to given replay time [ms]
+  auto replaySeek = [&](double time) {
+    replayClock.seek(time);
+    replaySeeked = true;
+  };
+
+  // SFML Window initialization
+  sf::ContextSettings settings;
+  settings.antialiasingLevel = 8;
+  sf::RenderWindow window(sf::VideoMode(width, height), "MonitoringViewer", sf::Style::Default, settings);
+  window.setView(view);
+  // Toggles must happen once per press, held seeking is handled below
+  window.setKeyRepeatEnabled(false);
+
+  // Is the field view inverted
+  int isInverted = 1;
+
+  // Heatmaps and ball trail, toggled with H and T
+  Overlays overlays;
+  bool showHeatmaps = false;
+  bool showTrails = false;
+
+  if (isReplay)
   {
-    startReplayTime = replayContainerTime[0];
-    endReplayTime = replayContainerTime[replayContainerTime.size() - 1];
+    startReplayTime = replayStore.getTime(0);
+    endReplayTime = replayStore.getTime(replayStore.size() - 1);
     replayTime = replayTargetTime = startReplayTime;
+    replayClock.seek(startReplayTime);
+  }
+
+  // Redraws happen on ingest updates, events and replay steps, and at
+  // least every maxRedrawPeriod [ms]. While idle, the loop waits for
+  // the ingest thread up to idleWaitMs, so that events are still polled
+  bool needsRedraw = true;
+  double nextRedraw = 0;
+  const double maxRedrawPeriod = 1000;
+  const double outdatedRedrawPeriod = 100;
+  const double idleWaitMs = 10;
+
+  // Left and Right seek by keySeekStep [ms] when pressed, then every
+  // keySeekPeriod [ms] once held for keySeekDelay [ms]
+  double nextKeySeek = 0;
+  const double keySeekStep = 10000;
+  const double keySeekDelay = 400;
+  const double keySeekPeriod = 100;
+  if (MAX_FPS > 0)
+  {
+    window.setFramerateLimit(MAX_FPS);
   }
 
   // Main loop
@@ -612,148 +1111,138 @@ int main(int argc, char** argv)
     bool isUpdate = false;
     if (!isReplay)
     {
-      // Receiving information
-      TeamPlayInfo info;
-      size_t len = sizeof(info);
-      while (broadcaster.checkMessage((unsigned char*)&info, len))
+      // Fetching the last state published by the ingest thread, which
+      // may only be a new referee IP, without any new message to log
+      if (ingest->poll())
       {
-        if (len != sizeof(info))
-        {
-          std::cout << "ERROR: TeamPlayService: invalid message of size=" << len << " instead of " << sizeof(info)
-                    << std::endl;
-          continue;
-        }
-        info.timestamp = TimeStamp::now().getTimeMS();
-        allInfo[info.id] = info;
-        std::cout << "Receiving data from id=" << info.id << " ts=" << std::setprecision(10) << info.timestamp
-                  << std::endl;
-        isUpdate = true;
+        needsRedraw = true;
       }
-
-      size_t captainLen = sizeof(captainInfo);
-      while (captainBroadcaster.checkMessage((unsigned char*)&captainInfo, captainLen))
+      const TeamSnapshot& snapshot = ingest->snapshot();
+      if (snapshot.updates != lastUpdates)
       {
-        if (captainLen != sizeof(captainInfo))
-        {
-          std::cout << "ERROR: TeamPlayService: invalid captain message of size=" << captainLen << " instead of "
-                    << sizeof(captainInfo) << std::endl;
-          continue;
-        }
-        info.timestamp = TimeStamp::now().getTimeMS();
-        std::cout << "Receiving captain data from id=" << captainInfo.id << " ts=" << std::setprecision(10)
-                  << info.timestamp << std::endl;
+        lastUpdates = snapshot.updates;
         isUpdate = true;
       }
+      team = &snapshot.team;
+      captainInfo = &snapshot.captainInfo;
+      refereeIp = snapshot.refereeIp;
+      badRefereeIp = snapshot.badRefereeIp;
 
-      size_t n = 1024;
-      uint8_t buffer[n];
-      std::string ip;
-      while (refereeBroadcaster.checkMessage(buffer, n, &ip))
+#ifdef USE_CAMERA
+      size_t frame = lastFrame.load();
+      if (frame != currentFrame)
       {
-        if (n > 500)
-        {
-          badRefereeIp = (ip != "192.168.1.100");
-          std::stringstream ss;
-          if (badRefereeIp)
-          {
-            ss << "Bad referee IP: ";
-          }
-          else
-          {
-            ss << "Referee IP: ";
-          }
-          ss << ip;
-          refereeIp = ss.str();
-        }
+        currentFrame = frame;
+        needsRedraw = true;
       }
+#endif
+      currentTime = TimeStamp::now().getTimeMS();
 
-#ifdef USE_CAMERA
-      frameMutex.lock();
-      if (hasNewFrame)
+      // Logging
+      if (isUpdate)
       {
-        currentFrame = lastFrame;
-        hasNewFrame = false;
-        isUpdate = true;
+        ReplayFrame record;
+        record.time = currentTime;
+        record.frame = currentFrame;
+        record.team = *team;
+        record.captainInfo = *captainInfo;
+        log.push(record);
+
+        overlays.add(*team, *captainInfo, currentTime);
       }
-      frameMutex.unlock();
-#endif
     }
     else
     {
-      auto before = replayContainerInfo[replayIndex];
-      if (!replayIsPaused && replayIndex < replayContainerInfo.size())
+      auto before = replaySample;
+      size_t previousIndex = replayIndex;
+      double previousTargetTime = replayTargetTime;
+      replayTargetTime = replayClock.time();
+      if (replayTargetTime < startReplayTime || replayTargetTime > endReplayTime)
       {
-        double sign = 1;
-        if (replayBackward)
-        {
-          sign = -1;
-        }
+        replayTargetTime = std::min(std::max(replayTargetTime, startReplayTime), endReplayTime);
+        replayClock.seek(replayTargetTime);
+      }
 
-        if (replaySuperFast)
-        {
-          replayTargetTime += sign * 1000;
-        }
-        else if (replayFast)
-        {
-          replayTargetTime += sign * 200;
-        }
-        else
-        {
-          replayTargetTime += sign * 50;
-        }
-        if (replayTargetTime < startReplayTime)
-          replayTargetTime = startReplayTime;
-        if (replayTargetTime > endReplayTime)
-          replayTargetTime = endReplayTime;
+      // Direct access to the sample at target time, only this one is decoded
+      replayIndex = replayStore.indexAt(replayTargetTime);
+      replayTime = replayStore.getTime(replayIndex);
+      replaySample = replayStore.get(replayIndex);
+      team = &replaySample->team;
+      captainInfo = &replaySample->captainInfo;
+      currentFrame = replaySample->frame;
+      // The camera follows the clock, even between two samples
+      currentTime = replayTargetTime;
+      if (replayTargetTime != previousTargetTime || replaySample != before)
+      {
+        needsRedraw = true;
+      }
 
-        while (replayTime < replayTargetTime && replayIndex < replayContainerTime.size() - 1)
-        {
-          allInfo = replayContainerInfo[replayIndex];
-          captainInfo = replayContainerCaptain[replayIndex];
-          replayTime = replayContainerTime[replayIndex];
-          currentFrame = replayContainerFrame[replayIndex];
-          replayIndex++;
-        }
-        while (replayTime > replayTargetTime && replayIndex > 0)
-        {
-          allInfo = replayContainerInfo[replayIndex];
-          captainInfo = replayContainerCaptain[replayIndex];
-          replayTime = replayContainerTime[replayIndex];
-          currentFrame = replayContainerFrame[replayIndex];
-          replayIndex--;
-        }
+      // Overlays restart from a seek, and only grow as the replay moves forward
+      if (replaySeeked)
+      {
+        overlays.clear();
+#ifdef USE_CAMERA
+        framePrefetcher.seek();
+#endif
       }
-      auto after = replayContainerInfo[replayIndex];
-      if (logRobot && before.count(logRobot) && after.count(logRobot))
+      if (replaySample != before)
       {
-        uint8_t h1 = before[logRobot].hour;
-        uint8_t m1 = before[logRobot].min;
-        uint8_t s1 = before[logRobot].sec;
-        uint8_t h2 = after[logRobot].hour;
-        uint8_t m2 = after[logRobot].min;
-        uint8_t s2 = after[logRobot].sec;
-        std::vector<Log::Entry> entries;
-        if (replayBackward)
+        overlays.add(*team, *captainInfo, replayTime);
+      }
+
+      // Printing the out.log entries up to the robot clock matching the replay time
+      if (logRobot && team->has(logRobot))
+      {
+        const TeamPlayInfo& info = team->get(logRobot);
+        double robotTime = Log::timeOf(info.hour, info.min, info.sec);
+        // Calibrating only from two successive samples of the replay, close enough
+        // in time to pin the second rollover of the robot clock to this packet
+        bool isNext = before && !replaySeeked && replayIndex == previousIndex + 1;
+        if (isNext && before->team.has(logRobot) && before->team.get(logRobot).sec != info.sec &&
+            info.timestamp - before->team.get(logRobot).timestamp <= outLogCalibrationGap)
         {
-          entries = outLog.entriesBetween(h2, m2, s2, h1, m1, s1);
+          // The robot clock just crossed a second when this packet was sent
+          outLogOffset = robotTime - info.timestamp;
+          outLogCalibrated = true;
         }
-        else
+        else if (!outLogCalibrated)
         {
-          entries = outLog.entriesBetween(h1, m1, s1, h2, m2, s2);
+          outLogOffset = robotTime + 500 - info.timestamp;
         }
 
-        for (auto& entry : entries)
+        uint32_t outLogTime = std::max(0.0, replayTargetTime + outLogOffset);
+        // Not dumping the whole out.log between both ends of a seek
+        if (hasOutLogTime && !replaySeeked)
         {
-          std::cout << "[OUT.LOG] " << entry.message << std::endl;
+          if (outLogTime >= lastOutLogTime)
+          {
+            for (const Log::Entry& entry : outLog.entriesBetween(lastOutLogTime, outLogTime))
+            {
+              std::cout << "[OUT.LOG] ";
+              std::cout.write(outLog.message(entry), entry.length);
+              std::cout << std::endl;
+            }
+          }
+          else
+          {
+            Log::Range range = outLog.entriesBetween(outLogTime, lastOutLogTime);
+            for (auto it = range.rbegin(); it != range.rend(); ++it)
+            {
+              std::cout << "[OUT.LOG] ";
+              std::cout.write(outLog.message(*it), it->length);
+              std::cout << std::endl;
+            }
+          }
         }
+        lastOutLogTime = outLogTime;
+        hasOutLogTime = true;
       }
-
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      replaySeeked = false;
     }
+
     // Handle events
-    sf::Event event;
-    while (window.pollEvent(event))
-    {
+    auto handleEvent = [&](const sf::Event& event) {
+      needsRedraw = true;
       // Quit events
       if (event.type == sf::Event::Closed)
       {
@@ -768,292 +1257,202 @@ int main(int argc, char** argv)
       {
         isInverted = -isInverted;
       }
-    }
-
-    // Replay user control
-    if (isReplay)
-    {
-      if (sf::Keyboard::isKeyPressed(sf::Keyboard::P))
+      // Toggle overlays
+      if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H)
       {
-        replayIsPaused = !replayIsPaused;
-        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        showHeatmaps = !showHeatmaps;
       }
-      replayFast = sf::Keyboard::isKeyPressed(sf::Keyboard::F);
-      replaySuperFast = sf::Keyboard::isKeyPressed(sf::Keyboard::S);
-      replayBackward = sf::Keyboard::isKeyPressed(sf::Keyboard::B);
-    }
-    // Start rendering
-    window.clear();
-    // Set camera view
-    window.setView(view);
-    // Draw logo
-    sf::Sprite sprite(logo);
-    sprite.setColor(sf::Color(255, 255, 255, 100));
-    sprite.setOrigin(sf::Vector2f(773 / 2.0, 960 / 2.0));
-    sprite.move(isInverted * -2.1, 0.2);
-    sprite.scale(0.0035, 0.0035);
-    window.draw(sprite, sf::RenderStates::Default);
-    // Draw RoboCup field
-    drawField(window);
-
-    // Draw referee IP
-    if (refereeIp != "")
-    {
-      drawText(window, refereeIp, sf::Vector2f(-0.75, 3.5), badRefereeIp ? 10 : 2);
-    }
-
-    Json::Value json(Json::objectValue);
-    // Logging
-    if (!isReplay && isUpdate)
-    {
-      json["ts"] = TimeStamp::now().getTimeMS();
-      json["frame"] = (unsigned int)currentFrame;
-      json["info"] = Json::arrayValue;
-      json["captain"] = captainToJson(captainInfo);
-    }
-    size_t index = 0;
-    // Draw players info
-    for (const auto& it : allInfo)
-    {
-      index++;
-      size_t id = it.first;
-      const TeamPlayInfo& info = it.second;
-      // Log data
-      if (!isReplay && isUpdate)
-      {
-        json["info"].append(teamPlayToJson(info));
-      }
-      // Retrieve robot
-      double yaw = info.fieldYaw;
-      sf::Vector2f robotPos(info.fieldX, info.fieldY);
-      // Invert field orientation
-      if (isInverted == -1)
-      {
-        yaw += M_PI;
-      }
-      robotPos.x *= isInverted;
-      robotPos.y *= isInverted;
-      // Compute ball positionin world
-      sf::Vector2f ballPos(cos(yaw) * info.ballX - sin(yaw) * info.ballY,
-                           sin(yaw) * info.ballX + cos(yaw) * info.ballY);
-      ballPos += robotPos;
-      // Draw info
-      double age;
-      if (!isReplay)
-      {
-        age = (TimeStamp::now().getTimeMS() - info.timestamp) / 1000.0;
-      }
-      else
-      {
-        age = (replayTime - info.timestamp) / 1000.0;
-      }
-      if (info.isPenalized() || age > 5.0)
-      {
-        double x = isInverted * (-robocup_referee::Constants::field.fieldLength / 2);
-        x += isInverted * 0.45 * (info.id - 1);
-        double y = isInverted * (-robocup_referee::Constants::field.fieldWidth / 2 - 0.3);
-        drawPlayer(window, sf::Vector2f(x, y), isInverted * 90.0, id);
-      }
-      else
+      if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::T)
       {
-        drawPlayer(window, sf::Vector2f(robotPos.x, robotPos.y), yaw * 180.0 / M_PI, id);
+        showTrails = !showTrails;
       }
-      if (info.ballQ > 0.0)
+      // Replay seeking
+      if (isReplay && event.type == sf::Event::KeyPressed)
       {
-        if (info.state != BallHandling)
+        sf::Keyboard::Key key = event.key.code;
+        if (key == sf::Keyboard::Home)
         {
-          globalAlpha = 100;
+          replaySeek(startReplayTime);
         }
-        drawBall(window, ballPos, id);
-
-        std::stringstream ssBall;
-        ssBall << std::fixed << std::setprecision(2) << info.ballQ;
-        drawText(window, ssBall.str(), ballPos - sf::Vector2f(0.0, 0.35), id);
-        globalAlpha = 255;
-
-        if (info.state == BallHandling || info.state == Playing)
+        if (key == sf::Keyboard::End)
         {
-          if (std::string(info.statePlaying) == "approach" || std::string(info.statePlaying) == "walkBall")
-          {
-            sf::Vector2f ballTarget(info.ballTargetX * isInverted, info.ballTargetY * isInverted);
-            drawBallArrow(window, ballPos, ballTarget, id);
-          }
+          replaySeek(endReplayTime);
+        }
+        if (key == sf::Keyboard::Left)
+        {
+          replaySeek(replayTargetTime - keySeekStep);
+          nextKeySeek = TimeStamp::now().getTimeMS() + keySeekDelay;
+        }
+        if (key == sf::Keyboard::Right)
+        {
+          replaySeek(replayTargetTime + keySeekStep);
+          nextKeySeek = TimeStamp::now().getTimeMS() + keySeekDelay;
+        }
+        // 0 to 9 jumps to 0% to 90% of the match
+        if (key >= sf::Keyboard::Num0 && key <= sf::Keyboard::Num9)
+        {
+          replaySeek(replayStore.getTime(replayStore.indexAtRatio((key - sf::Keyboard::Num0) / 10.0)));
+        }
+        if (key == sf::Keyboard::P)
+        {
+          replayClock.setPaused(!replayClock.isPaused());
+        }
+        // Base speed, from x1/16 slow motion to x16
+        if (key == sf::Keyboard::Up)
+        {
+          replaySpeed = std::min(replaySpeed * 2, 16.0);
+        }
+        if (key == sf::Keyboard::Down)
+        {
+          replaySpeed = std::max(replaySpeed / 2, 1 / 16.0);
         }
       }
+    };
+    sf::Event event;
+    while (window.pollEvent(event))
+    {
+      handleEvent(event);
+    }
 
-      // Draw consensus ball
-      if (captainInfo.id > 0)
-      {
-        auto ball = captainInfo.common_ball;
-        sf::Vector2f ballPos(ball.x * isInverted, ball.y * isInverted);
-        drawBall(window, ballPos, 0);
-
-        std::stringstream ssBall;
-        ssBall << captainInfo.common_ball.nbRobots;
-        drawText(window, ssBall.str(), ballPos + sf::Vector2f(0.0, 0.35), 0);
-      }
-
-      // Draw placing target
-      if (info.placing)
-      {
-        drawTarget(window, sf::Vector2f(robotPos.x, robotPos.y),
-                   sf::Vector2f(info.localTargetX * isInverted, info.localTargetY * isInverted),
-                   sf::Vector2f(info.targetX * isInverted, info.targetY * isInverted), id);
-      }
-      // Print information
-      sfe::RichText text(font);
-      text << getColor(id);
-
-      text << sf::Text::Bold;
-      {
-        std::stringstream ss;
-        ss << id;
-        text << "ID " << ss.str() << " - ";
-      }
-      if (id == 1)
-        text << "Olive";
-      if (id == 2)
-        text << "Nova";
-      if (id == 3)
-        text << "Arya";
-      if (id == 4)
-        text << "Tom";
-      if (id == 5)
-        text << "Rush";
-      if (id == 6)
-        text << "Django";
-
-      {
-        std::stringstream ss;
-        ss << " [" << (int)info.hour << ":" << (int)info.min << ":" << (int)info.sec << "]";
-        text << ss.str();
-      }
-
-      if (captainInfo.id == info.id)
-      {
-        text << sf::Color(255, 175, 0) << " (Captain)";
-        text << getColor(info.id);
-      }
-      text << "\n";
-      text << sf::Text::Regular;
-      text << "State: ";
-      if (info.state == Inactive)
-      {
-        text << "Inactive";
-      }
-      if (info.state == Playing)
-      {
-        text << "Playing";
-      }
-      if (info.state == BallHandling)
-      {
-        text << "BallHandling";
-      }
-      if (info.state == GoalKeeping)
-      {
-        text << "GoalKeeping";
-      }
-      if (info.state == Unknown)
+    // Replay speed modifiers, while their key is held
+    if (isReplay)
+    {
+      double speed = replaySpeed;
+      if (sf::Keyboard::isKeyPressed(sf::Keyboard::S))
       {
-        text << "Unknown";
+        speed *= 20;
       }
-      text << "\n";
-      text << "Referee: " << info.stateReferee << "\n";
-      text << "RoboCup: " << info.stateRobocup << "\n";
-      text << "Playing: " << info.statePlaying << "\n";
-      text << "Search: " << info.stateSearch << "\n";
-
+      else if (sf::Keyboard::isKeyPressed(sf::Keyboard::F))
       {
-        std::stringstream ss;
-        ss << "FieldQ: " << std::fixed << std::setprecision(2) << info.fieldQ << std::endl;
-        ss << "FieldConsistency: " << std::fixed << std::setprecision(2) << info.fieldConsistency << std::endl;
-        ss << "TimeSinceLastKick: " << std::fixed << std::setprecision(2) << info.timeSinceLastKick << std::endl;
-        text << ss.str();
+        speed *= 4;
       }
-
-      if (info.hardwareWarnings[0] != '\0')
+      if (sf::Keyboard::isKeyPressed(sf::Keyboard::B))
       {
-        text << sf::Color::Red;
-        text << std::string(info.hardwareWarnings) << "\n";
-        text << getColor(id);
+        speed = -speed;
       }
+      replayClock.setSpeed(speed);
 
-      if (age > 5.0)
+      bool seekBackward = sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
+      bool seekForward = sf::Keyboard::isKeyPressed(sf::Keyboard::Right);
+      double keyTime = TimeStamp::now().getTimeMS();
+      if (seekBackward != seekForward && keyTime >= nextKeySeek)
       {
-        text << sf::Color::Red;
-        std::stringstream ss;
-        ss << "Outdated (" << age << "s)";
-        text << ss.str();
-        text << getColor(id);
+        replaySeek(replayTargetTime + (seekForward ? keySeekStep : -keySeekStep));
+        nextKeySeek = keyTime + keySeekPeriod;
+        needsRedraw = true;
       }
+    }
 
-      if (index == 1)
-      {
-        drawText(window, text, sf::Vector2f(-6.5, 3.0), id);
-      }
-      else if (index == 2)
-      {
-        drawText(window, text, sf::Vector2f(-6.5, 0.75), id);
-      }
-      else if (index == 3)
-      {
-        drawText(window, text, sf::Vector2f(-6.5, -1.5), id);
-      }
-      else if (index == 4)
+    // Rendering only when something changed, waiting for the
+    // next ingest snapshot otherwise
+    double now = TimeStamp::now().getTimeMS();
+    if (!isUpdate && !needsRedraw && now < nextRedraw)
+    {
+      if (!isReplay)
       {
-        drawText(window, text, sf::Vector2f(4.75, 3.0), id);
+        ingest->wait(idleWaitMs);
       }
       else
       {
-        drawText(window, text, sf::Vector2f(4.75, 0.75), id);
-      }
-      if (isReplay)
-      {
-        std::stringstream ssTime;
-        ssTime << "Time: " << std::fixed << std::setprecision(2) << (replayTime - startReplayTime) / 1000.0 << "s";
-        drawText(window, ssTime.str(), sf::Vector2f(0.0, 3.5), 0);
+        // Paused or stuck at an end of the replay, nothing moves until the next input
+        if (window.waitEvent(event))
+        {
+          handleEvent(event);
+        }
       }
+      continue;
     }
+    needsRedraw = false;
+    nextRedraw = now + maxRedrawPeriod;
+
+    // Start rendering
+    window.clear();
+    // Set camera view
+    window.setView(view);
+    // Field view, drawn the same way by the headless rendering
+    Scene scene;
+    scene.team = team;
+    scene.captainInfo = captainInfo;
+    scene.refereeIp = refereeIp;
+    scene.badRefereeIp = badRefereeIp;
+    scene.isInverted = isInverted;
+    scene.time = isReplay ? replayTime : now;
+    scene.isReplay = isReplay;
+    scene.replayPosition = replayTargetTime - startReplayTime;
+    scene.replaySpeed = replayClock.getSpeed();
+    scene.overlays = &overlays;
+    scene.showHeatmaps = showHeatmaps;
+    scene.showTrails = showTrails;
+    drawScene(window, scene, cache);
 
-    // Draw obstacles
-    for (int k = 0; k < captainInfo.nb_opponents; k++)
+    if (!isReplay)
     {
-      auto& opponent = captainInfo.common_opponents[k];
-      int alpha = 60 + opponent.consensusStrength * 50;
-      if (alpha > 255)
+      // The age is shown once outdated, or the robot becomes outdated
+      for (const TeamPlayInfo& info : *team)
       {
-        alpha = 255;
+        double age = (now - info.timestamp) / 1000.0;
+        nextRedraw = std::min(nextRedraw, age > 5.0 ? now + outdatedRedrawPeriod : info.timestamp + 5000.0);
       }
+    }
 
-      drawObstacle(window, sf::Vector2f(opponent.x * isInverted, opponent.y * isInverted), 0.6, 0, alpha);
+#ifdef USE_CAMERA
+    // Camera frame matching the displayed state
+    if (!isReplay)
+    {
+      cameraView.showLive(frameRing, currentTime);
     }
+    else
+    {
+      cameraView.showReplay(frameStore, framePrefetcher, currentTime, currentFrame);
+    }
+    cameraView.draw(window);
 
-    if (!isReplay && isUpdate)
+    // Measured offset between the shown camera frame and the state
+    if (cameraView.hasSkew())
     {
-      Json::FastWriter writer;
-      log << writer.write(json);
+      std::stringstream ssSkew;
+      ssSkew << "Camera skew: " << std::fixed << std::setprecision(0) << cameraView.getSkew() << "ms";
+      drawText(window, ssSkew.str(), sf::Vector2f(2.5, 3.5), 0);
     }
-    log.flush();
+#endif
 
     window.display();
   }
 
   stopped = true;
 
+  if (ingest != NULL)
+  {
+    ingest->stop();
+    delete ingest;
+  }
+
   if (!isReplay)
   {
-    std::cout << "Writing log to " << logFilename << std::endl;
     log.close();
+    LogWriter::Stats stats = log.getStats();
+    std::cout << "Wrote " << stats.records << " records (" << stats.bytesWritten << " bytes, " << stats.dropped
+              << " dropped, longest flush " << stats.maxFlushMs << "ms) to " << logFilename << std::endl;
   }
 
   if (capture != NULL)
   {
     capture->join();
   }
-  if (show != NULL)
+  if (record != NULL)
   {
-    show->join();
+    record->join();
+#ifdef USE_CAMERA
+    frameEncoder.stop();
+    frameWriter.close();
+    FrameEncoder::Stats stats = frameEncoder.getStats();
+    std::cout << "Encoded " << stats.encoded << " frames (" << stats.dropped << " dropped, " << stats.late
+              << " late, longest " << stats.maxLatencyMs << "ms)" << std::endl;
+#endif
   }
+#ifdef USE_CAMERA
+  framePrefetcher.stop();
+#endif
 
   return 0;
 }
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "parallel.h"
+
+std::vector<TextChunk> splitLines(const char* data, size_t size, size_t chunkSize)
+{
+  std::vector<TextChunk> chunks;
+  const char* begin = data;
+  const char* end = data + size;
+
+  while (begin < end)
+  {
+    const char* chunkEnd = end;
+    if ((size_t)(end - begin) > chunkSize)
+    {
+      const char* newline = (const char*)memchr(begin + chunkSize, '\n', end - begin - chunkSize);
+      if (newline != nullptr)
+      {
+        chunkEnd = newline + 1;
+      }
+    }
+    chunks.push_back(TextChunk(begin, chunkEnd));
+    begin = chunkEnd;
+  }
+
+  return chunks;
+}
+
+void parallelFor(size_t n, std::function<void(size_t)> task, std::function<void(size_t, size_t)> progress)
+{
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> done(0);
+
+  // Workers pull the next task until none is left
+  auto worker = [&]() {
+    size_t k;
+    while ((k = next++) < n)
+    {
+      task(k);
+      done++;
+    }
+  };
+
+  size_t nbThreads = std::max<size_t>(1, std::min<size_t>(n, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t k = 0; k < nbThreads; k++)
+  {
+    threads.push_back(std::thread(worker));
+  }
+
+  if (progress)
+  {
+    while (done < n)
+    {
+      progress(done, n);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    progress(n, n);
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+typedef std::pair<const char*, const char*> TextChunk;
+
+/**
+ * Split [data, data + size) into chunks of about chunkSize bytes,
+ * each chunk ending right after a newline (or at the end of data)
+ */
+std::vector<TextChunk> splitLines(const char* data, size_t size, size_t chunkSize = 4 * 1024 * 1024);
+
+/**
+ * Run task(k) for k in [0, n) on one thread per core and wait for
+ * completion. If given, progress(done, n) is called periodically
+ * from the calling thread
+ */
+void parallelFor(size_t n, std::function<void(size_t)> task,
+                 std::function<void(size_t, size_t)> progress = std::function<void(size_t, size_t)>());
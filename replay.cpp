@@ -0,0 +1,357 @@
+#include <iostream>
+#include <cstring>
+#include "replay.h"
+
+using namespace rhoban_team_play;
+
+static const char replayMagic[4] = { 'R', 'H', 'R', 'P' };
+
+ReplayFrame::ReplayFrame() : time(0), frame(0)
+{
+  memset(&captainInfo, 0, sizeof(captainInfo));
+}
+
+template <typename T>
+static void put(std::string& out, size_t offset, T value)
+{
+  memcpy(&out[offset], &value, sizeof(value));
+}
+
+template <typename T>
+static T get(const char* data)
+{
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+/**
+ * Append given structure to out, collapsing runs of zero bytes.
+ * Each chunk starts with a control byte c: if c < 0x80, c+1 literal
+ * bytes follow, else the chunk is (c & 0x7f)+1 zero bytes
+ */
+static void pack(const void* data, size_t size, std::string& out)
+{
+  const uint8_t* bytes = (const uint8_t*)data;
+  size_t k = 0;
+  while (k < size)
+  {
+    size_t n = 0;
+    if (bytes[k] == 0)
+    {
+      while (k + n < size && n < 128 && bytes[k + n] == 0)
+      {
+        n++;
+      }
+      out += (char)(0x80 | (n - 1));
+    }
+    else
+    {
+      // Isolated zeros are kept in literals, runs of two or more are collapsed
+      while (k + n < size && n < 128 && (bytes[k + n] != 0 || (k + n + 1 < size && bytes[k + n + 1] != 0)))
+      {
+        n++;
+      }
+      out += (char)(n - 1);
+      out.append((const char*)bytes + k, n);
+    }
+    k += n;
+  }
+}
+
+/**
+ * Unpack a structure of given size from data, advancing it.
+ * Return false on corrupted input
+ */
+static bool unpack(const char*& data, const char* end, void* target, size_t size)
+{
+  uint8_t* bytes = (uint8_t*)target;
+  size_t k = 0;
+  while (k < size)
+  {
+    if (data >= end)
+    {
+      return false;
+    }
+    uint8_t control = *data++;
+    size_t n = (control & 0x7f) + 1;
+    if (k + n > size)
+    {
+      return false;
+    }
+    if (control & 0x80)
+    {
+      memset(bytes + k, 0, n);
+    }
+    else
+    {
+      if (data + n > end)
+      {
+        return false;
+      }
+      memcpy(bytes + k, data, n);
+      data += n;
+    }
+    k += n;
+  }
+
+  return true;
+}
+
+void replayEncodeHeader(std::string& out)
+{
+  size_t offset = out.size();
+  out.resize(offset + REPLAY_HEADER_SIZE);
+  memcpy(&out[offset], replayMagic, sizeof(replayMagic));
+  put<uint16_t>(out, offset + 4, REPLAY_VERSION);
+  put<uint16_t>(out, offset + 6, 0);
+  put<uint32_t>(out, offset + 8, sizeof(TeamPlayInfo));
+  put<uint32_t>(out, offset + 12, sizeof(CaptainInfo));
+}
+
+/**
+ * XOR size bytes of b into a
+ */
+static void xorBytes(void* a, const void* b, size_t size)
+{
+  uint8_t* x = (uint8_t*)a;
+  const uint8_t* y = (const uint8_t*)b;
+  for (size_t k = 0; k < size; k++)
+  {
+    x[k] ^= y[k];
+  }
+}
+
+/**
+ * Pack value, XORed with previous if given
+ */
+template <typename T>
+static void packDelta(const T& value, const T* previous, std::string& out)
+{
+  if (previous == nullptr)
+  {
+    pack(&value, sizeof(T), out);
+  }
+  else
+  {
+    T delta = value;
+    xorBytes(&delta, previous, sizeof(T));
+    pack(&delta, sizeof(T), out);
+  }
+}
+
+/**
+ * Unpack value, XORed with its current content if isDelta
+ */
+template <typename T>
+static bool unpackDelta(const char*& data, const char* end, T& value, bool isDelta)
+{
+  T delta;
+  if (!unpack(data, end, &delta, sizeof(T)))
+  {
+    return false;
+  }
+  if (isDelta)
+  {
+    xorBytes(&value, &delta, sizeof(T));
+  }
+  else
+  {
+    value = delta;
+  }
+
+  return true;
+}
+
+bool replayIsBinary(const char* data, size_t size)
+{
+  return size >= sizeof(replayMagic) && memcmp(data, replayMagic, sizeof(replayMagic)) == 0;
+}
+
+bool replayCheckHeader(const char* header)
+{
+  uint16_t version = get<uint16_t>(header + 4);
+  uint32_t infoSize = get<uint32_t>(header + 8);
+  uint32_t captainSize = get<uint32_t>(header + 12);
+  if (version != REPLAY_VERSION || infoSize != sizeof(TeamPlayInfo) ||
+      captainSize != sizeof(CaptainInfo))
+  {
+    std::cerr << "Replay: unsupported binary replay (version " << version << ", info size " << infoSize
+              << ", captain size " << captainSize << ")" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+size_t replayRecordHeader(const char* header, uint8_t* flags, double* time, size_t* frame)
+{
+  if (flags != nullptr)
+  {
+    *flags = get<uint8_t>(header + 4);
+  }
+  if (time != nullptr)
+  {
+    *time = get<double>(header + 8);
+  }
+  if (frame != nullptr)
+  {
+    *frame = get<uint64_t>(header + 16);
+  }
+
+  return get<uint32_t>(header);
+}
+
+bool replayDecodeRecord(const char* record, size_t size, ReplayFrame& frame)
+{
+  if (size < REPLAY_RECORD_HEADER_SIZE)
+  {
+    return false;
+  }
+
+  uint8_t flags;
+  size_t payload = replayRecordHeader(record, &flags, &frame.time, &frame.frame);
+  uint8_t nbInfo = get<uint8_t>(record + 5);
+  if (payload + REPLAY_RECORD_HEADER_SIZE > size)
+  {
+    return false;
+  }
+
+  bool isKeyframe = (flags & REPLAY_FLAG_KEYFRAME) != 0;
+  if (isKeyframe)
+  {
+    frame.team.clear();
+    memset(&frame.captainInfo, 0, sizeof(CaptainInfo));
+  }
+
+  const char* data = record + REPLAY_RECORD_HEADER_SIZE;
+  const char* end = data + payload;
+  for (size_t k = 0; k < nbInfo; k++)
+  {
+    if (data >= end)
+    {
+      return false;
+    }
+    int id = (uint8_t)*data++;
+    if (!TeamState::isValidId(id))
+    {
+      return false;
+    }
+    bool isDelta = frame.team.has(id);
+    if (!unpackDelta(data, end, frame.team.at(id), isDelta))
+    {
+      return false;
+    }
+  }
+
+  if (flags & REPLAY_FLAG_CAPTAIN)
+  {
+    if (!unpackDelta(data, end, frame.captainInfo, !isKeyframe))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool replayDecodeJson(const std::string& line, ReplayFrame& frame)
+{
+  Json::Reader reader;
+  Json::Value json;
+
+  // Trying to parse
+  if (!reader.parse(line, json) || !json.isMember("ts") || !json.isMember("frame"))
+  {
+    return false;
+  }
+
+  frame.time = json["ts"].asDouble();
+  frame.frame = json["frame"].asUInt();
+  frame.team.clear();
+  for (auto& infoJson : json["info"])
+  {
+    TeamPlayInfo info;
+    teamPlayfromJson(info, infoJson);
+    frame.team.set(info);
+  }
+  captainFromJson(frame.captainInfo, json["captain"]);
+
+  return true;
+}
+
+ReplayEncoder::ReplayEncoder(double keyframeInterval)
+  : keyframeInterval(keyframeInterval), hasKeyframe(false), lastKeyframe(0)
+{
+}
+
+void ReplayEncoder::reset()
+{
+  hasKeyframe = false;
+}
+
+void ReplayEncoder::encode(const ReplayFrame& frame, std::string& out)
+{
+  bool isKeyframe = !hasKeyframe || frame.time - lastKeyframe >= keyframeInterval || frame.time < lastKeyframe;
+
+  // Deltas can't remove robots
+  for (auto& info : previous.team)
+  {
+    if (!frame.team.has(info.id))
+    {
+      isKeyframe = true;
+    }
+  }
+
+  if (isKeyframe)
+  {
+    hasKeyframe = true;
+    lastKeyframe = frame.time;
+    previous.team.clear();
+    memset(&previous.captainInfo, 0, sizeof(CaptainInfo));
+  }
+
+  size_t offset = out.size();
+  out.resize(offset + REPLAY_RECORD_HEADER_SIZE);
+
+  uint8_t flags = isKeyframe ? REPLAY_FLAG_KEYFRAME : 0;
+  uint8_t nbInfo = 0;
+  for (auto& info : frame.team)
+  {
+    const TeamPlayInfo* previousInfo = nullptr;
+    if (previous.team.has(info.id))
+    {
+      previousInfo = &previous.team.get(info.id);
+      // Skipping robots that did not change
+      if (memcmp(previousInfo, &info, sizeof(TeamPlayInfo)) == 0)
+      {
+        continue;
+      }
+    }
+
+    out += (char)info.id;
+    packDelta(info, previousInfo, out);
+    nbInfo++;
+  }
+
+  bool captainChanged = memcmp(&previous.captainInfo, &frame.captainInfo, sizeof(CaptainInfo)) != 0;
+  if (captainChanged)
+  {
+    flags |= REPLAY_FLAG_CAPTAIN;
+    packDelta(frame.captainInfo, isKeyframe ? nullptr : &previous.captainInfo, out);
+  }
+
+  put<uint32_t>(out, offset, out.size() - offset - REPLAY_RECORD_HEADER_SIZE);
+  put<uint8_t>(out, offset + 4, flags);
+  put<uint8_t>(out, offset + 5, nbInfo);
+  put<uint16_t>(out, offset + 6, 0);
+  put<double>(out, offset + 8, frame.time);
+  put<uint64_t>(out, offset + 16, frame.frame);
+
+  // Remember the robots the reader will know about
+  for (auto& info : frame.team)
+  {
+    previous.team.set(info);
+  }
+  previous.captainInfo = frame.captainInfo;
+}
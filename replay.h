@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <rhoban_team_play/team_play.h>
+#include "team_state.h"
+
+/**
+ * Binary replay format version
+ */
+#define REPLAY_VERSION 1
+
+/**
+ * One recorded sample of the team state
+ */
+struct ReplayFrame
+{
+  ReplayFrame();
+
+  // Monitoring time stamp [ms]
+  double time;
+  // Camera frame number
+  size_t frame;
+
+  TeamState team;
+  rhoban_team_play::CaptainInfo captainInfo;
+};
+
+/**
+ * Binary replay file layout (host endianness):
+ *
+ * File header: "RHRP" magic, uint16 version, uint16 reserved,
+ *   uint32 sizeof(TeamPlayInfo), uint32 sizeof(CaptainInfo)
+ *
+ * Then records: uint32 payload size, uint8 flags, uint8 number of
+ *   robots, uint16 reserved, double time, uint64 frame, followed by
+ *   the robots (uint8 id and packed TeamPlayInfo) and the packed
+ *   CaptainInfo.
+ *
+ * Keyframes hold the full state. Other records only hold the robots
+ * and captain that changed since the previous record, XORed with
+ * their previous value so that unchanged fields become zeros.
+ *
+ * Structures are packed by collapsing runs of zero bytes, which
+ * removes the padding of their fixed size strings.
+ */
+#define REPLAY_HEADER_SIZE 16
+#define REPLAY_RECORD_HEADER_SIZE 24
+
+/**
+ * Record flags
+ */
+#define REPLAY_FLAG_CAPTAIN 0x01
+#define REPLAY_FLAG_KEYFRAME 0x02
+
+/**
+ * Append the file header to out
+ */
+void replayEncodeHeader(std::string& out);
+
+/**
+ * Is given data starting with a binary replay header
+ */
+bool replayIsBinary(const char* data, size_t size);
+
+/**
+ * Check that the binary header is of a file this build can read
+ */
+bool replayCheckHeader(const char* header);
+
+/**
+ * Read the record header, return the payload size
+ */
+size_t replayRecordHeader(const char* header, uint8_t* flags = nullptr, double* time = nullptr,
+                          size_t* frame = nullptr);
+
+/**
+ * Apply the record (header and payload) to frame, which must hold
+ * the sample preceding this record unless it is a keyframe.
+ * Return false on corrupted records
+ */
+bool replayDecodeRecord(const char* record, size_t size, ReplayFrame& frame);
+
+/**
+ * Decode one legacy JSON line. Return false if the line
+ * is not a valid replay sample
+ */
+bool replayDecodeJson(const std::string& line, ReplayFrame& frame);
+
+/**
+ * Encodes the samples as keyframes or deltas against the
+ * previously encoded sample
+ */
+class ReplayEncoder
+{
+public:
+  /**
+   * A full keyframe is written every keyframeInterval [ms]
+   */
+  ReplayEncoder(double keyframeInterval = 5000);
+
+  /**
+   * Append the record for given frame to out
+   */
+  void encode(const ReplayFrame& frame, std::string& out);
+
+  /**
+   * Force the next record to be a keyframe
+   */
+  void reset();
+
+protected:
+  double keyframeInterval;
+  bool hasKeyframe;
+  double lastKeyframe;
+
+  // Last encoded state
+  ReplayFrame previous;
+};
@@ -0,0 +1,49 @@
+#include "replay_clock.h"
+
+ReplayClock::ReplayClock() : origin(Clock::now()), originTime(0), speed(1), paused(false)
+{
+}
+
+double ReplayClock::time() const
+{
+  if (paused)
+  {
+    return originTime;
+  }
+
+  return originTime + speed * std::chrono::duration<double, std::milli>(Clock::now() - origin).count();
+}
+
+void ReplayClock::seek(double time)
+{
+  origin = Clock::now();
+  originTime = time;
+}
+
+void ReplayClock::setSpeed(double newSpeed)
+{
+  if (newSpeed != speed)
+  {
+    seek(time());
+    speed = newSpeed;
+  }
+}
+
+double ReplayClock::getSpeed() const
+{
+  return speed;
+}
+
+void ReplayClock::setPaused(bool newPaused)
+{
+  if (newPaused != paused)
+  {
+    seek(time());
+    paused = newPaused;
+  }
+}
+
+bool ReplayClock::isPaused() const
+{
+  return paused;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+
+/**
+ * Replay time driven by the monotonic wall clock.
+ *
+ * The replay time advances at speed times the wall clock, whatever
+ * the render rate. It stays continuous across speed changes, pauses
+ * only stop it and seeks move it.
+ */
+class ReplayClock
+{
+public:
+  ReplayClock();
+
+  /**
+   * Current replay time [ms]
+   */
+  double time() const;
+
+  /**
+   * Jump to given replay time [ms]
+   */
+  void seek(double time);
+
+  /**
+   * Playback speed, fractional for slow motion and negative
+   * to play backward
+   */
+  void setSpeed(double speed);
+  double getSpeed() const;
+
+  void setPaused(bool paused);
+  bool isPaused() const;
+
+protected:
+  typedef std::chrono::steady_clock Clock;
+
+  // Replay time at the wall clock origin [ms]
+  Clock::time_point origin;
+  double originTime;
+
+  double speed;
+  bool paused;
+};
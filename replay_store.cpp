@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "parallel.h"
+#include "replay_store.h"
+
+ReplayStore::ReplayStore(size_t cacheSize) : binary(false), cacheSize(cacheSize)
+{
+}
+
+bool ReplayStore::open(const std::string& filename, Progress progress)
+{
+  offsets.clear();
+  times.clear();
+  keyframes.clear();
+  cache.clear();
+
+  if (!file.open(filename, MappedFile::Sequential))
+  {
+    return false;
+  }
+
+  binary = replayIsBinary(file.data(), file.size());
+  bool isOk = binary ? indexBinary(progress) : indexJson(progress);
+  // Samples are then read at the replay time, seeks and backward playback included
+  file.advise(MappedFile::Random);
+
+  return isOk;
+}
+
+size_t ReplayStore::size() const
+{
+  return times.size();
+}
+
+double ReplayStore::getTime(size_t index) const
+{
+  return times[index];
+}
+
+size_t ReplayStore::indexAt(double time) const
+{
+  auto it = std::upper_bound(times.begin(), times.end(), time);
+  if (it == times.begin())
+  {
+    return 0;
+  }
+
+  return (it - times.begin()) - 1;
+}
+
+size_t ReplayStore::indexAtRatio(double ratio) const
+{
+  if (times.empty())
+  {
+    return 0;
+  }
+  ratio = std::max(0.0, std::min(1.0, ratio));
+
+  return indexAt(times.front() + ratio * (times.back() - times.front()));
+}
+
+std::shared_ptr<const ReplayFrame> ReplayStore::get(size_t index)
+{
+  // Cache hit, moving it to the front
+  for (auto it = cache.begin(); it != cache.end(); it++)
+  {
+    if (it->first == index)
+    {
+      cache.splice(cache.begin(), cache, it);
+      return cache.front().second;
+    }
+  }
+
+  FramePtr frame = decode(index);
+  cache.push_front(std::make_pair(index, frame));
+  if (cache.size() > cacheSize)
+  {
+    cache.pop_back();
+  }
+
+  return frame;
+}
+
+bool ReplayStore::indexBinary(Progress progress)
+{
+  if (file.size() < REPLAY_HEADER_SIZE)
+  {
+    return false;
+  }
+  if (!replayCheckHeader(file.data()))
+  {
+    return false;
+  }
+
+  // Hopping from record header to record header
+  size_t offset = REPLAY_HEADER_SIZE;
+  while (offset + REPLAY_RECORD_HEADER_SIZE <= file.size())
+  {
+    uint8_t flags;
+    double time;
+    size_t size = replayRecordHeader(file.data() + offset, &flags, &time);
+    if (offset + REPLAY_RECORD_HEADER_SIZE + size > file.size())
+    {
+      std::cerr << "Replay: truncated record at end of file" << std::endl;
+      break;
+    }
+
+    if (flags & REPLAY_FLAG_KEYFRAME)
+    {
+      keyframes.push_back(times.size());
+    }
+    else if (keyframes.empty())
+    {
+      // Deltas without a preceding keyframe can't be decoded
+      offset += REPLAY_RECORD_HEADER_SIZE + size;
+      continue;
+    }
+    offsets.push_back(offset);
+    times.push_back(time);
+
+    offset += REPLAY_RECORD_HEADER_SIZE + size;
+    if (progress && times.size() % 65536 == 0)
+    {
+      progress(offset / (double)file.size());
+    }
+  }
+  if (progress)
+  {
+    progress(1.0);
+  }
+
+  return true;
+}
+
+/**
+ * Parse the number starting at value, which must end before end
+ */
+static bool parseNumber(const char* value, const char* end, double& number)
+{
+  // Copied, as the mapping is not null terminated
+  char buffer[64];
+  size_t length = std::min<size_t>(end - value, sizeof(buffer) - 1);
+  memcpy(buffer, value, length);
+  buffer[length] = '\0';
+
+  char* numberEnd;
+  number = strtod(buffer, &numberEnd);
+
+  return numberEnd != buffer;
+}
+
+/**
+ * Scan a JSON line for the time stamp and frame of its top level
+ * object, ignoring the same keys in nested objects and the content of
+ * strings. Return false if the line is not a complete object holding
+ * both of them
+ */
+static bool scanJsonLine(const char* begin, const char* end, double& ts, double& frame)
+{
+  const char* it = begin;
+  while (it < end && isspace((unsigned char)*it))
+  {
+    it++;
+  }
+  if (it == end || *it != '{')
+  {
+    return false;
+  }
+
+  bool hasTs = false, hasFrame = false;
+  int depth = 0;
+  for (; it < end; it++)
+  {
+    char c = *it;
+    if (c == '"')
+    {
+      const char* key = it + 1;
+      for (it++; it < end && *it != '"'; it++)
+      {
+        if (*it == '\\')
+        {
+          it++;
+        }
+      }
+      if (it >= end)
+      {
+        return false;
+      }
+      size_t length = it - key;
+
+      // Keys are followed by a colon, values are not
+      const char* value = it + 1;
+      while (value < end && isspace((unsigned char)*value))
+      {
+        value++;
+      }
+      if (depth != 1 || value == end || *value != ':')
+      {
+        continue;
+      }
+      value++;
+      if (length == 2 && memcmp(key, "ts", 2) == 0)
+      {
+        hasTs = parseNumber(value, end, ts);
+      }
+      if (length == 5 && memcmp(key, "frame", 5) == 0)
+      {
+        hasFrame = parseNumber(value, end, frame);
+      }
+    }
+    else if (c == '{' || c == '[')
+    {
+      depth++;
+    }
+    else if (c == '}' || c == ']')
+    {
+      depth--;
+      if (depth < 0)
+      {
+        return false;
+      }
+    }
+  }
+
+  return depth == 0 && hasTs && hasFrame;
+}
+
+/**
+ * Index of a part of a JSON replay
+ */
+struct JsonChunkIndex
+{
+  std::vector<uint64_t> offsets;
+  std::vector<double> times;
+  // Non empty lines that could not be indexed
+  size_t skipped = 0;
+};
+
+bool ReplayStore::indexJson(Progress progress)
+{
+  const char* data = file.data();
+  std::vector<TextChunk> chunks = splitLines(data, file.size());
+  std::vector<JsonChunkIndex> indexes(chunks.size());
+
+  parallelFor(chunks.size(),
+              [&](size_t k) {
+                JsonChunkIndex& index = indexes[k];
+                const char* line = chunks[k].first;
+                const char* end = chunks[k].second;
+                while (line < end)
+                {
+                  const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+                  if (lineEnd == nullptr)
+                  {
+                    lineEnd = end;
+                  }
+
+                  // Only extracting the time stamp and frame, the line is parsed when needed
+                  double ts, frame;
+                  if (scanJsonLine(line, lineEnd, ts, frame))
+                  {
+                    index.offsets.push_back(line - data);
+                    index.times.push_back(ts);
+                  }
+                  else if (std::find_if(line, lineEnd, [](char c) { return !isspace((unsigned char)c); }) != lineEnd)
+                  {
+                    index.skipped++;
+                  }
+
+                  line = lineEnd + 1;
+                }
+              },
+              [&](size_t done, size_t total) {
+                if (progress)
+                {
+                  progress(done / (double)total);
+                }
+              });
+
+  // Merging the chunks in file order
+  size_t skipped = 0;
+  for (auto& index : indexes)
+  {
+    offsets.insert(offsets.end(), index.offsets.begin(), index.offsets.end());
+    times.insert(times.end(), index.times.begin(), index.times.end());
+    skipped += index.skipped;
+  }
+  if (skipped > 0)
+  {
+    std::cerr << "Skipped " << skipped << " malformed replay lines" << std::endl;
+  }
+
+  return true;
+}
+
+ReplayStore::FramePtr ReplayStore::decode(size_t index)
+{
+  if (binary)
+  {
+    return decodeBinary(index);
+  }
+  else
+  {
+    return decodeJson(index);
+  }
+}
+
+ReplayStore::FramePtr ReplayStore::decodeBinary(size_t index)
+{
+  // Nearest keyframe before the sample
+  size_t keyframe = *(std::upper_bound(keyframes.begin(), keyframes.end(), index) - 1);
+
+  // Starting from the closest cached sample between the keyframe and the sample
+  std::shared_ptr<ReplayFrame> frame(new ReplayFrame);
+  size_t start = keyframe;
+  for (auto& entry : cache)
+  {
+    if (entry.first < index && entry.first >= start)
+    {
+      start = entry.first + 1;
+      *frame = *entry.second;
+    }
+  }
+
+  for (size_t k = start; k <= index; k++)
+  {
+    const char* record = file.data() + offsets[k];
+    size_t size = REPLAY_RECORD_HEADER_SIZE + replayRecordHeader(record);
+    if (!replayDecodeRecord(record, size, *frame))
+    {
+      std::cerr << "Replay: corrupted record #" << k << std::endl;
+      break;
+    }
+  }
+
+  return frame;
+}
+
+ReplayStore::FramePtr ReplayStore::decodeJson(size_t index)
+{
+  const char* data = file.data();
+  const char* line = data + offsets[index];
+  const char* lineEnd = (const char*)memchr(line, '\n', data + file.size() - line);
+  if (lineEnd == nullptr)
+  {
+    lineEnd = data + file.size();
+  }
+
+  std::shared_ptr<ReplayFrame> frame(new ReplayFrame);
+  replayDecodeJson(std::string(line, lineEnd), *frame);
+
+  return frame;
+}
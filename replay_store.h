@@ -0,0 +1,82 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "replay.h"
+
+/**
+ * Memory mapped replay file, either binary or legacy JSON lines.
+ *
+ * Opening only builds a light index of the samples (offset, time
+ * and camera frame), samples are decoded on demand and the most
+ * recently used ones are kept in a small cache. JSON files are
+ * indexed by chunks on all cores.
+ */
+class ReplayStore
+{
+public:
+  typedef std::function<void(double)> Progress;
+
+  ReplayStore(size_t cacheSize = 16);
+
+  /**
+   * Open and index given file, progress is called with the
+   * indexed ratio of the file while this is running
+   */
+  bool open(const std::string& filename, Progress progress = Progress());
+
+  /**
+   * Number of samples
+   */
+  size_t size() const;
+
+  /**
+   * Time stamp [ms] of given sample
+   */
+  double getTime(size_t index) const;
+
+  /**
+   * Last sample at or before given time [ms], or the first one.
+   * Samples are recorded with increasing time stamps, this is a
+   * binary search over the index
+   */
+  size_t indexAt(double time) const;
+
+  /**
+   * Sample at given ratio of the replay duration, in [0, 1]
+   */
+  size_t indexAtRatio(double ratio) const;
+
+  /**
+   * Decoded sample
+   */
+  std::shared_ptr<const ReplayFrame> get(size_t index);
+
+protected:
+  typedef std::shared_ptr<const ReplayFrame> FramePtr;
+
+  bool indexBinary(Progress progress);
+  bool indexJson(Progress progress);
+
+  FramePtr decode(size_t index);
+  FramePtr decodeBinary(size_t index);
+  FramePtr decodeJson(size_t index);
+
+  MappedFile file;
+  bool binary;
+
+  // Index, one entry per sample
+  std::vector<uint64_t> offsets;
+  std::vector<double> times;
+
+  // Samples that are keyframes
+  std::vector<size_t> keyframes;
+
+  // Recently decoded samples, most recent first
+  size_t cacheSize;
+  std::list<std::pair<size_t, FramePtr>> cache;
+};
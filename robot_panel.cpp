@@ -0,0 +1,143 @@
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include "robot_panel.h"
+
+using namespace rhoban_team_play;
+
+/**
+ * Character size and scale of the texts on the field view
+ */
+static const unsigned int characterSize = 18;
+static const double textScale = 0.008;
+
+static const char* stateName(int state)
+{
+  switch (state)
+  {
+    case Inactive:
+      return "Inactive";
+    case Playing:
+      return "Playing";
+    case BallHandling:
+      return "BallHandling";
+    case GoalKeeping:
+      return "GoalKeeping";
+    case Unknown:
+      return "Unknown";
+  }
+
+  return "";
+}
+
+/**
+ * Are both values shown the same with 2 decimals
+ */
+static bool isSameValue(double a, double b)
+{
+  return std::lround(a * 100) == std::lround(b * 100);
+}
+
+#define SAME_STRING(field) (strncmp(a.field, b.field, sizeof(a.field)) == 0)
+
+RobotPanel::RobotPanel() : isBuilt(false), isCaptain(false)
+{
+  memset(&info, 0, sizeof(info));
+}
+
+bool RobotPanel::update(const TeamPlayInfo& newInfo, const std::string& newName, const sf::Color& newColor,
+                        bool newIsCaptain, double age, const sf::Font& font)
+{
+  bool isRebuilt = false;
+  if (!isBuilt || !isSame(info, newInfo) || name != newName || color != newColor || isCaptain != newIsCaptain)
+  {
+    info = newInfo;
+    name = newName;
+    color = newColor;
+    isCaptain = newIsCaptain;
+    build(font);
+    isBuilt = true;
+    isRebuilt = true;
+  }
+
+  // The age is the only field refreshed on every update
+  ageText.clear();
+  if (age > 5.0)
+  {
+    ageText.setFont(font);
+    ageText.setCharacterSize(characterSize);
+    std::stringstream ss;
+    ss << "Outdated (" << age << "s)";
+    ageText << sf::Color::Red << ss.str();
+  }
+
+  return isRebuilt;
+}
+
+void RobotPanel::draw(sf::RenderTarget& target, const sf::Vector2f& pos, double scale) const
+{
+  sf::RenderStates states;
+  states.transform.translate(pos.x, -pos.y - textScale * scale * 20.0);
+  states.transform.scale(textScale * scale, textScale * scale);
+  target.draw(text, states);
+
+  // The panel ends with a new line, where the age goes
+  if (!text.getLines().empty())
+  {
+    states.transform.translate(0, text.getLines().back().getPosition().y);
+  }
+  target.draw(ageText, states);
+}
+
+bool RobotPanel::isSame(const TeamPlayInfo& a, const TeamPlayInfo& b)
+{
+  return a.id == b.id && a.hour == b.hour && a.min == b.min && a.sec == b.sec && a.state == b.state &&
+         SAME_STRING(stateReferee) && SAME_STRING(stateRobocup) && SAME_STRING(statePlaying) &&
+         SAME_STRING(stateSearch) && SAME_STRING(hardwareWarnings) && isSameValue(a.fieldQ, b.fieldQ) &&
+         isSameValue(a.fieldConsistency, b.fieldConsistency) && isSameValue(a.timeSinceLastKick, b.timeSinceLastKick);
+}
+
+void RobotPanel::build(const sf::Font& font)
+{
+  text.clear();
+  text.setFont(font);
+  text.setCharacterSize(characterSize);
+  text << color;
+
+  text << sf::Text::Bold;
+  {
+    std::stringstream ss;
+    ss << "ID " << (int)info.id << " - " << name;
+    ss << " [" << (int)info.hour << ":" << (int)info.min << ":" << (int)info.sec << "]";
+    text << ss.str();
+  }
+
+  if (isCaptain)
+  {
+    text << sf::Color(255, 175, 0) << " (Captain)";
+    text << color;
+  }
+  text << "\n";
+  text << sf::Text::Regular;
+  text << "State: " << stateName(info.state) << "\n";
+  text << "Referee: " << info.stateReferee << "\n";
+  text << "RoboCup: " << info.stateRobocup << "\n";
+  text << "Playing: " << info.statePlaying << "\n";
+  text << "Search: " << info.stateSearch << "\n";
+
+  {
+    std::stringstream ss;
+    ss << "FieldQ: " << std::fixed << std::setprecision(2) << info.fieldQ << std::endl;
+    ss << "FieldConsistency: " << std::fixed << std::setprecision(2) << info.fieldConsistency << std::endl;
+    ss << "TimeSinceLastKick: " << std::fixed << std::setprecision(2) << info.timeSinceLastKick << std::endl;
+    text << ss.str();
+  }
+
+  if (info.hardwareWarnings[0] != '\0')
+  {
+    text << sf::Color::Red;
+    text << std::string(info.hardwareWarnings) << "\n";
+    text << color;
+  }
+}
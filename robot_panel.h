@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <SFML/Graphics.hpp>
+#include <rhoban_team_play/team_play.h>
+#include "RichText.hpp"
+
+/**
+ * Information panel of one robot.
+ *
+ * The text and its layout are kept from frame to frame and only
+ * rebuilt when one of the shown fields changes. The age of outdated
+ * robots, which changes continuously, is a separate line.
+ */
+class RobotPanel
+{
+public:
+  RobotPanel();
+
+  /**
+   * Update the panel from given information, return true if
+   * its text had to be rebuilt
+   */
+  bool update(const rhoban_team_play::TeamPlayInfo& info, const std::string& name, const sf::Color& color,
+              bool isCaptain, double age, const sf::Font& font);
+
+  /**
+   * Draw the panel, pos being its top left corner on the field view,
+   * scaled by scale
+   */
+  void draw(sf::RenderTarget& target, const sf::Vector2f& pos, double scale = 1) const;
+
+protected:
+  /**
+   * Are the fields shown by the panel the same in a and b
+   */
+  static bool isSame(const rhoban_team_play::TeamPlayInfo& a, const rhoban_team_play::TeamPlayInfo& b);
+
+  void build(const sf::Font& font);
+
+  // Shown values
+  bool isBuilt;
+  rhoban_team_play::TeamPlayInfo info;
+  std::string name;
+  sf::Color color;
+  bool isCaptain;
+
+  sfe::RichText text;
+  sfe::RichText ageText;
+};
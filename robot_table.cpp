@@ -0,0 +1,102 @@
+#include <fstream>
+#include <iostream>
+#include <json/json.h>
+#include "robot_table.h"
+
+RobotTable::RobotTable()
+{
+  defaultStyle.color = sf::Color(200, 200, 200);
+  for (int id = 0; id < MAX_ROBOTS; id++)
+  {
+    robots[id] = defaultStyle;
+    indexes[id] = id;
+    order.push_back(id);
+  }
+}
+
+bool RobotTable::load(const std::string& filename)
+{
+  std::ifstream file(filename);
+  Json::Reader reader;
+  Json::Value json;
+  if (!file.good() || !reader.parse(file, json) || !json.isObject() || !json["robots"].isArray())
+  {
+    std::cerr << "Can't read robots from " << filename << std::endl;
+    return false;
+  }
+
+  RobotStyle newRobots[MAX_ROBOTS];
+  std::vector<bool> isConfigured(MAX_ROBOTS, false);
+  std::vector<int> newOrder;
+  for (int id = 0; id < MAX_ROBOTS; id++)
+  {
+    newRobots[id] = defaultStyle;
+  }
+
+  for (const Json::Value& robot : json["robots"])
+  {
+    int id = robot.get("id", -1).asInt();
+    const Json::Value& color = robot["color"];
+    if (!TeamState::isValidId(id) || !color.isArray() || color.size() != 3)
+    {
+      std::cerr << "Invalid robot in " << filename << ": " << robot.toStyledString() << std::endl;
+      return false;
+    }
+
+    RobotStyle& style = newRobots[id];
+    style.team = robot.get("team", "").asString();
+    style.name = robot.get("name", "").asString();
+    style.color = sf::Color(color[0].asInt(), color[1].asInt(), color[2].asInt());
+    if (!isConfigured[id])
+    {
+      isConfigured[id] = true;
+      newOrder.push_back(id);
+    }
+  }
+
+  // Robots missing from the file are laid out after the others
+  for (int id = 0; id < MAX_ROBOTS; id++)
+  {
+    if (!isConfigured[id])
+    {
+      newOrder.push_back(id);
+    }
+  }
+
+  for (int id = 0; id < MAX_ROBOTS; id++)
+  {
+    robots[id] = newRobots[id];
+  }
+  order = newOrder;
+  for (size_t k = 0; k < order.size(); k++)
+  {
+    indexes[order[k]] = k;
+  }
+
+  return true;
+}
+
+const RobotStyle& RobotTable::get(int id) const
+{
+  if (!TeamState::isValidId(id))
+  {
+    return defaultStyle;
+  }
+
+  return robots[id];
+}
+
+const std::vector<int>& RobotTable::getOrder() const
+{
+  return order;
+}
+
+size_t RobotTable::getIndex(int id) const
+{
+  if (!TeamState::isValidId(id))
+  {
+    return 0;
+  }
+
+  return indexes[id];
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <SFML/Graphics/Color.hpp>
+#include "team_state.h"
+
+/**
+ * Display settings of one robot
+ */
+struct RobotStyle
+{
+  std::string team;
+  std::string name;
+  sf::Color color;
+};
+
+/**
+ * Display settings of all robots, in a dense table indexed by id and
+ * loaded once at startup, so that drawing never searches for them.
+ *
+ * The team play messages carry no team, robots of several teams on the
+ * same field being told apart by their id. The configured robots come
+ * first in the layout order, in the order of the file (teams being
+ * listed one after the other), followed by the other ids.
+ */
+class RobotTable
+{
+public:
+  RobotTable();
+
+  /**
+   * Load the robots from given JSON file, of the form:
+   *
+   *   {"robots": [{"id": 1, "team": "Rhoban", "name": "Olive", "color": [210, 0, 255]}, ...]}
+   *
+   * Return false, keeping the current table, if it can't be read
+   */
+  bool load(const std::string& filename);
+
+  /**
+   * Settings of given robot, the default ones for unknown or invalid ids
+   */
+  const RobotStyle& get(int id) const;
+
+  /**
+   * Ids of all robots, in layout order
+   */
+  const std::vector<int>& getOrder() const;
+
+  /**
+   * Position of given robot in the layout order
+   */
+  size_t getIndex(int id) const;
+
+protected:
+  RobotStyle robots[MAX_ROBOTS];
+  RobotStyle defaultStyle;
+  size_t indexes[MAX_ROBOTS];
+  std::vector<int> order;
+};
@@ -0,0 +1,70 @@
+#include <cmath>
+#include "shape_batch.h"
+
+ShapeBatch::ShapeBatch() : vertices(sf::Triangles)
+{
+}
+
+void ShapeBatch::clear()
+{
+  // Keeps the storage, so that refilling does not allocate
+  vertices.clear();
+}
+
+void ShapeBatch::addRectangle(const sf::Vector2f& size, const sf::Vector2f& origin, const sf::Vector2f& position,
+                              float angle, const sf::Color& color)
+{
+  sf::Transform transform;
+  transform.translate(position);
+  transform.rotate(angle);
+  transform.translate(-origin);
+
+  sf::Vector2f a = transform.transformPoint(0, 0);
+  sf::Vector2f b = transform.transformPoint(size.x, 0);
+  sf::Vector2f c = transform.transformPoint(size.x, size.y);
+  sf::Vector2f d = transform.transformPoint(0, size.y);
+  addTriangle(a, b, c, color);
+  addTriangle(a, c, d, color);
+}
+
+void ShapeBatch::addRing(const sf::Vector2f& position, float radius, float thickness, const sf::Color& color,
+                         size_t points)
+{
+  float outer = radius + thickness;
+  for (size_t k = 0; k < points; k++)
+  {
+    float a1 = 2 * M_PI * k / points;
+    float a2 = 2 * M_PI * (k + 1) / points;
+    sf::Vector2f u1(cos(a1), sin(a1));
+    sf::Vector2f u2(cos(a2), sin(a2));
+    addTriangle(position + u1 * radius, position + u1 * outer, position + u2 * outer, color);
+    addTriangle(position + u1 * radius, position + u2 * outer, position + u2 * radius, color);
+  }
+}
+
+void ShapeBatch::addDisc(const sf::Vector2f& position, float radius, const sf::Color& color, size_t points)
+{
+  for (size_t k = 0; k < points; k++)
+  {
+    float a1 = 2 * M_PI * k / points;
+    float a2 = 2 * M_PI * (k + 1) / points;
+    addTriangle(position, position + sf::Vector2f(cos(a1), sin(a1)) * radius,
+                position + sf::Vector2f(cos(a2), sin(a2)) * radius, color);
+  }
+}
+
+void ShapeBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+  if (vertices.getVertexCount() > 0)
+  {
+    target.draw(vertices, states);
+  }
+}
+
+void ShapeBatch::addTriangle(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& c,
+                             const sf::Color& color)
+{
+  vertices.append(sf::Vertex(a, color));
+  vertices.append(sf::Vertex(b, color));
+  vertices.append(sf::Vertex(c, color));
+}
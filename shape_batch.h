@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+/**
+ * Untextured shapes accumulated into a single triangle vertex
+ * array, so that all of them are drawn with one draw call.
+ *
+ * Shapes are placed like their sf::Shape counterpart: the origin
+ * is moved to the position, the rotation [deg] being around it,
+ * and outlines are drawn outside of the shape.
+ */
+class ShapeBatch : public sf::Drawable
+{
+public:
+  ShapeBatch();
+
+  void clear();
+
+  /**
+   * Filled rectangle, as sf::RectangleShape
+   */
+  void addRectangle(const sf::Vector2f& size, const sf::Vector2f& origin, const sf::Vector2f& position, float angle,
+                    const sf::Color& color);
+
+  /**
+   * Outline of a circle centered on position, as a sf::CircleShape
+   * with a transparent fill
+   */
+  void addRing(const sf::Vector2f& position, float radius, float thickness, const sf::Color& color,
+               size_t points = 30);
+
+  /**
+   * Filled circle centered on position
+   */
+  void addDisc(const sf::Vector2f& position, float radius, const sf::Color& color, size_t points = 30);
+
+protected:
+  void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+  void addTriangle(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& c, const sf::Color& color);
+
+  sf::VertexArray vertices;
+};
@@ -0,0 +1,104 @@
+#include <cstring>
+#include "team_state.h"
+
+using namespace rhoban_team_play;
+
+TeamState::const_iterator::const_iterator(const TeamState* state, int id) : state(state), id(id)
+{
+  while (this->id < MAX_ROBOTS && !state->present[this->id])
+  {
+    this->id++;
+  }
+}
+
+const TeamPlayInfo& TeamState::const_iterator::operator*() const
+{
+  return state->robots[id];
+}
+
+const TeamPlayInfo* TeamState::const_iterator::operator->() const
+{
+  return &state->robots[id];
+}
+
+TeamState::const_iterator& TeamState::const_iterator::operator++()
+{
+  do
+  {
+    id++;
+  } while (id < MAX_ROBOTS && !state->present[id]);
+
+  return *this;
+}
+
+bool TeamState::const_iterator::operator!=(const const_iterator& other) const
+{
+  return id != other.id;
+}
+
+TeamState::TeamState()
+{
+  memset(robots, 0, sizeof(robots));
+  clear();
+}
+
+void TeamState::clear()
+{
+  for (int id = 0; id < MAX_ROBOTS; id++)
+  {
+    present[id] = false;
+  }
+  count = 0;
+}
+
+size_t TeamState::size() const
+{
+  return count;
+}
+
+bool TeamState::isValidId(int id)
+{
+  return id >= 0 && id < MAX_ROBOTS;
+}
+
+bool TeamState::has(int id) const
+{
+  return isValidId(id) && present[id];
+}
+
+const TeamPlayInfo& TeamState::get(int id) const
+{
+  return robots[id];
+}
+
+TeamPlayInfo& TeamState::at(int id)
+{
+  if (!present[id])
+  {
+    present[id] = true;
+    count++;
+  }
+
+  return robots[id];
+}
+
+bool TeamState::set(const TeamPlayInfo& info)
+{
+  if (!isValidId(info.id))
+  {
+    return false;
+  }
+  at(info.id) = info;
+
+  return true;
+}
+
+TeamState::const_iterator TeamState::begin() const
+{
+  return const_iterator(this, 0);
+}
+
+TeamState::const_iterator TeamState::end() const
+{
+  return const_iterator(this, MAX_ROBOTS);
+}
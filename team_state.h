@@ -0,0 +1,65 @@
+#pragma once
+
+#include <rhoban_team_play/team_play.h>
+
+/**
+ * Maximum number of robots, ids are in [0, MAX_ROBOTS), enough for
+ * several teams sharing the field
+ */
+#define MAX_ROBOTS 64
+
+/**
+ * Team play information of all robots, stored in a dense
+ * table indexed by robot id
+ */
+class TeamState
+{
+public:
+  /**
+   * Iterates over the present robots, by increasing id
+   */
+  class const_iterator
+  {
+  public:
+    const_iterator(const TeamState* state, int id);
+    const rhoban_team_play::TeamPlayInfo& operator*() const;
+    const rhoban_team_play::TeamPlayInfo* operator->() const;
+    const_iterator& operator++();
+    bool operator!=(const const_iterator& other) const;
+
+  protected:
+    const TeamState* state;
+    int id;
+  };
+
+  TeamState();
+
+  void clear();
+
+  /**
+   * Number of present robots
+   */
+  size_t size() const;
+
+  static bool isValidId(int id);
+  bool has(int id) const;
+  const rhoban_team_play::TeamPlayInfo& get(int id) const;
+
+  /**
+   * Slot for given robot, which becomes present. The id must be valid
+   */
+  rhoban_team_play::TeamPlayInfo& at(int id);
+
+  /**
+   * Store given information, return false if its id is invalid
+   */
+  bool set(const rhoban_team_play::TeamPlayInfo& info);
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+protected:
+  rhoban_team_play::TeamPlayInfo robots[MAX_ROBOTS];
+  bool present[MAX_ROBOTS];
+  size_t count;
+};
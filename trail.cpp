@@ -0,0 +1,46 @@
+#include <cmath>
+#include "trail.h"
+
+Trail::Trail(size_t capacity, double minDistance)
+  : positions(capacity), minDistance(minDistance), head(0), count(0)
+{
+}
+
+void Trail::clear()
+{
+  head = 0;
+  count = 0;
+}
+
+void Trail::add(const sf::Vector2f& pos)
+{
+  if (positions.empty())
+  {
+    return;
+  }
+  if (count > 0)
+  {
+    sf::Vector2f diff = pos - get(count - 1);
+    if (std::sqrt(diff.x * diff.x + diff.y * diff.y) < minDistance)
+    {
+      return;
+    }
+  }
+
+  positions[head] = pos;
+  head = (head + 1) % positions.size();
+  if (count < positions.size())
+  {
+    count++;
+  }
+}
+
+size_t Trail::size() const
+{
+  return count;
+}
+
+const sf::Vector2f& Trail::get(size_t k) const
+{
+  return positions[(head + positions.size() - count + k) % positions.size()];
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+/**
+ * Last positions of a moving object, kept in a fixed size ring so
+ * that adding one is O(1) however long the trail has been fed
+ */
+class Trail
+{
+public:
+  /**
+   * Keeps up to capacity positions, a position being added only once
+   * at least minDistance [m] away from the last one
+   */
+  Trail(size_t capacity, double minDistance);
+
+  void clear();
+  void add(const sf::Vector2f& pos);
+
+  size_t size() const;
+
+  /**
+   * Position k of the trail, from the oldest (0) to the newest
+   */
+  const sf::Vector2f& get(size_t k) const;
+
+protected:
+  std::vector<sf::Vector2f> positions;
+  double minDistance;
+  // Next slot to write and number of stored positions
+  size_t head, count;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Lock-free single producer / single consumer handoff of
+ * the latest value of T.
+ *
+ * The producer fills back() and calls publish(), the consumer
+ * calls update() and reads front(). None of them ever block or
+ * wait for the other side, intermediate values that were not
+ * picked up by the consumer are simply overwritten.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+  TripleBuffer() : middle(1), backIndex(0), frontIndex(2)
+  {
+  }
+
+  /**
+   * Producer side: buffer to fill before publishing
+   */
+  T& back()
+  {
+    return buffers[backIndex];
+  }
+
+  /**
+   * Producer side: make the back buffer available to the consumer
+   */
+  void publish()
+  {
+    backIndex = middle.exchange(backIndex | DIRTY, std::memory_order_acq_rel) & INDEX;
+  }
+
+  /**
+   * Consumer side: fetch the last published buffer, if any.
+   * Returns true if front() changed
+   */
+  bool update()
+  {
+    if (!(middle.load(std::memory_order_relaxed) & DIRTY))
+    {
+      return false;
+    }
+    frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  /**
+   * Consumer side: last fetched buffer
+   */
+  const T& front() const
+  {
+    return buffers[frontIndex];
+  }
+
+protected:
+  static const uint8_t INDEX = 0x3;
+  static const uint8_t DIRTY = 0x4;
+
+  T buffers[3];
+
+  // Index of the buffer shared between both sides, with DIRTY flag
+  std::atomic<uint8_t> middle;
+
+  // Owned by the producer
+  uint8_t backIndex;
+
+  // Owned by the consumer
+  uint8_t frontIndex;
+};